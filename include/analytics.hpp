@@ -0,0 +1,53 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include "tile.hpp"
+#include <string>
+#include <vector>
+
+// Port-to-port statistics of a random tile. transition[p][q] is the chance
+// that a player leaving the previous tile through global port p leaves the
+// next tile through global port q, over every matching the generator can
+// produce and every orientation.
+struct TileStatistics
+{
+    int matching_count;
+    double transition [POS_LAST][POS_LAST];
+};
+
+struct ScoreAnalysis
+{
+    int width;
+    int height;
+    int max_score;
+    // Approximate expected score from the independent-draw chain.
+    double chain_score;
+    // Probability of still being on the board after max_score moves.
+    double tail_probability;
+    // distribution[n] is the chain's approximate probability of finishing
+    // with a score of n.
+    std::vector<double> distribution;
+    // Mean score of real playouts, used to measure the chain's bias. Zero
+    // playouts means it was not measured.
+    int playout_count;
+    double measured_score;
+};
+
+TileStatistics ComputeTileStatistics(ThreadPool& pool);
+
+// Evaluates the Markov chain over (tile, port) in which every tile entered is
+// an independent draw from the tile statistics. Routes that never revisit a
+// tile are scored exactly, but a revisited tile is drawn afresh instead of
+// keeping its paths and their taken state. The result is an approximation
+// whose error grows with board size (measured at about +6% on 5x5 and +22%
+// on 21x21), so it should not be used to compare board sizes on its own;
+// MeasureMeanScore gives the unbiased figure.
+ScoreAnalysis AnalyzeScore(const TileStatistics& stats, int width, int height, int max_score, ThreadPool& pool);
+
+// Plays playout_count seeded random games to the end with TraversalBatch and
+// returns their mean score.
+double MeasureMeanScore(int width, int height, int playout_count, ThreadPool& pool);
+
+std::string GetScoreAnalysisCachePath(const std::string& cache_dir, int width, int height, int max_score, int playout_count);
+bool LoadScoreAnalysis(const std::string& path, ScoreAnalysis& r_analysis);
+bool SaveScoreAnalysis(const std::string& path, const ScoreAnalysis& analysis);
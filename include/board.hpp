@@ -14,6 +14,7 @@ public:
     int getHeight() const;
 
     bool isOnGrid(int i, int j) const;
+    bool isInHexShape(int i, int j) const;
     
     Tile* getTile(int i, int j) const;
     Tile* getTileInDirection(Direction dir, int i, int j) const;
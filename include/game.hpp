@@ -1,9 +1,21 @@
 #pragma once
 
 #include "board.hpp"
+#include "hint_solver.hpp"
+#include "latency.hpp"
+#include "mesh_packer.hpp"
+#include "render_target.hpp"
+#include "resolution_scaler.hpp"
+#include "route_trail.hpp"
+#include "sprite_cache.hpp"
+#include "timeline.hpp"
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
 
 class Game
 {
@@ -11,9 +23,24 @@ public:
     Game(int width, int height);
     ~Game();
 
+    void setLowLatency(bool is_low_latency, int render_delay_ms);
     void run();
 
 private:
+    struct PendingProgram
+    {
+        GLuint* p_program;
+        std::vector<GLuint> shaders;
+        std::vector<std::string> paths;
+    };
+
+    struct FrameInFlight
+    {
+        GLsync fence;
+        std::vector<Uint32> input_ticks;
+    };
+
+    Timeline startup_;
     SDL_Window* p_window_ = nullptr;
     bool is_running_ = false;
 
@@ -23,20 +50,65 @@ private:
     Position player_pos_;
     Tile* player_tile_;
 
+    HintSolver hint_solver_;
+    bool is_hint_enabled_ = false;
+    bool is_hint_dirty_ = true;
+
     GLuint base_program_ = 0u;
     GLuint path_program_ = 0u;
-    GLuint tile_vao_ = 0u;
-    GLuint tile_vbo_ = 0u;
-    GLuint path_vao_ = 0u;
-    GLuint path_vbo_ = 0u;
-    GLuint path_offsets_ [POS_LAST][POS_LAST][2];
+    GLuint sprite_program_ = 0u;
+    GLuint mesh_vao_ = 0u;
+    GLuint mesh_vbo_ = 0u;
+    GLuint mesh_ebo_ = 0u;
+    MeshPacker mesh_packer_;
+    PackedRange tile_range_;
+    PackedRange path_ranges_ [POS_LAST][POS_LAST];
+    GLuint sprite_vao_ = 0u;
+    GLuint sprite_vbo_ = 0u;
+    std::vector<GLfloat> sprite_vertex_buffer_;
+    std::vector<const Tile*> uncached_tiles_;
+    SpriteCache sprite_cache_;
+    RouteTrail route_trail_;
+    std::vector<GLfloat> trail_segment_;
+    int trail_length_ = 0;
+
+    bool is_low_latency_ = false;
+    int render_delay_ms_ = 0;
+    std::deque<FrameInFlight> frames_in_flight_;
+    std::vector<Uint32> frame_input_ticks_;
+    LatencyHistogram swap_latency_;
+    LatencyHistogram finish_latency_;
+
+    std::vector<PendingProgram> pending_programs_;
+    std::future<void> board_ready_;
+    std::future<void> meshes_ready_;
     glm::mat4 view_;
+    int window_width_ = 0;
+    int window_height_ = 0;
+    int drawable_width_ = 0;
+    int drawable_height_ = 0;
+    bool is_target_dirty_ = true;
+    RenderTarget render_target_;
+    ResolutionScaler resolution_scaler_;
 
+    void beginProgram(GLuint* p_program, const std::string& vertex_path, const std::string& fragment_path);
+    void resize(int width, int height);
+    void resizeRenderTarget();
     void setupShaders();
+    void finishShaders();
     void destroyShaders();
+    void buildMeshes();
     void setupMeshes();
     void destroyMeshes();
     void setupBoard();
+    bool retireFrameInFlight(GLuint64 timeout);
+    void pollFramesInFlight(bool is_blocking);
+    void waitForFramesInFlight();
     void processInput();
+    void updateHint(HintSolver::Clock::time_point frame_start);
+    void appendTrail(const Tile* p_tile, Position from_pos);
+    void drawTrail(const glm::mat4& board_view);
+    void drawTile(const Tile* p_tile, const glm::mat4& world_view);
+    void drawHint(const glm::mat4& board_view);
     void drawBoard();
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "board.hpp"
+#include "tile.hpp"
+#include <chrono>
+#include <vector>
+
+struct HintSegment
+{
+    const Tile* p_tile;
+    Direction orientation;
+    Path path;
+};
+
+// Finds the orientation of the player's tile that gives the longest route if
+// nothing else on the board is rotated. The search is split into small slices
+// so it can run inside a per-frame time budget and resume on the next frame.
+class HintSolver
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit HintSolver(const Board& board);
+
+    void restart(const Tile* p_start, Position start_pos);
+    void update(Clock::time_point deadline);
+
+    bool isFinished() const { return is_finished_; }
+    Direction getBestOrientation() const { return best_orientation_; }
+    const std::vector<HintSegment>& getRoute() const { return best_route_; }
+
+private:
+    const Board& board_;
+    const Tile* p_start_ = nullptr;
+    Position start_pos_ = POS_NORTH_EAST_0;
+    bool is_finished_ = true;
+
+    int candidate_ = 0;
+    int candidate_count_ = 0;
+    Direction orientation_ = DIR_NORTH_EAST;
+    const Tile* p_tile_ = nullptr;
+    Position pos_ = POS_NORTH_EAST_0;
+    std::vector<HintSegment> route_;
+
+    // Local ports taken by the route being simulated, so the board itself is
+    // never modified.
+    std::vector<unsigned short> taken_;
+    std::vector<int> touched_;
+
+    Direction best_orientation_ = DIR_NORTH_EAST;
+    std::vector<HintSegment> best_route_;
+
+    void beginCandidate();
+    void endCandidate();
+    bool advance();
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+// Histogram of latencies in whole milliseconds. Samples past the last bucket
+// are clamped into it.
+class LatencyHistogram
+{
+public:
+    explicit LatencyHistogram(int bucket_count);
+
+    void addSample(int milliseconds);
+    int getSampleCount() const { return sample_count_; }
+    int getPercentile(float fraction) const;
+    void report(std::ostream& out) const;
+
+private:
+    std::vector<int> buckets_;
+    int sample_count_ = 0;
+    long long total_ = 0;
+    int max_ = 0;
+};
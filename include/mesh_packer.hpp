@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Positions in [-1, 1] and alpha in [0, 1], stored as 16-bit normalized
+// integers and padded to eight bytes to keep attributes aligned.
+struct PackedVertex
+{
+    GLshort x;
+    GLshort y;
+    GLushort alpha;
+    GLushort padding;
+};
+
+struct PackedRange
+{
+    GLsizei first;
+    GLsizei count;
+};
+
+// Collects strips and fans into a single indexed mesh. pack() quantizes the
+// vertices, merges identical ones, orders primitives so neighbours share
+// vertices, and numbers vertices in the order they are first used. Each
+// primitive is drawn on its own from its range, so ranges are packed back to
+// back with no separators.
+class MeshPacker
+{
+public:
+    int addPrimitive(const std::vector<glm::vec2>& positions, const std::vector<GLfloat>& alphas);
+    void pack();
+
+    const std::vector<PackedVertex>& getVertices() const { return vertices_; }
+    const std::vector<GLushort>& getIndices() const { return indices_; }
+    PackedRange getRange(int primitive) const { return ranges_[primitive]; }
+    size_t getPackedBytes() const;
+
+    static glm::vec2 UnpackPosition(const PackedVertex& vertex);
+    static float UnpackAlpha(const PackedVertex& vertex);
+
+private:
+    std::vector<std::vector<PackedVertex>> primitives_;
+    std::vector<PackedVertex> vertices_;
+    std::vector<GLushort> indices_;
+    std::vector<PackedRange> ranges_;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Offscreen color target, optionally multisampled, that is resolved and
+// scaled onto the default framebuffer once the frame is drawn.
+class RenderTarget
+{
+public:
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+    int getSamples() const { return samples_; }
+
+    void resize(int width, int height, int samples);
+    void destroy();
+
+    void bind();
+    void resolve(int window_width, int window_height);
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int samples_ = 0;
+    GLuint msaa_fbo_ = 0u;
+    GLuint msaa_color_ = 0u;
+    GLuint resolve_fbo_ = 0u;
+    GLuint resolve_color_ = 0u;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Picks a render scale and MSAA sample count from a fixed ladder of quality
+// levels so that measured GPU frame time stays under a budget. Timer queries
+// are read a few frames late so measuring never stalls the pipeline.
+class ResolutionScaler
+{
+public:
+    explicit ResolutionScaler(float budget_ms);
+
+    void setup(int max_samples);
+    void destroy();
+
+    void beginFrame();
+    bool endFrame();
+
+    float getScale() const;
+    int getSamples() const;
+    float getAverageMs() const { return average_ms_; }
+
+private:
+    static const int QUERY_COUNT = 4;
+
+    float budget_ms_;
+    int max_samples_ = 0;
+    int level_ = 0;
+    float average_ms_ = 0.f;
+    int frames_since_change_ = 0;
+
+    GLuint queries_ [QUERY_COUNT];
+    int frame_ = 0;
+    bool is_setup_ = false;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <GL/glew.h>
+
+// Append-only line strip of (x, y, alpha) vertices kept in a GPU buffer.
+// Appends only write the new range: through a persistent mapping when
+// ARB_buffer_storage is available, otherwise through an unsynchronized map.
+// Neither needs a fence, because a range is never rewritten once a draw may
+// read it; growing copies into new storage on the GPU.
+class RouteTrail
+{
+public:
+    void setup();
+    void destroy();
+
+    void append(const GLfloat* p_vertices, size_t vertex_count);
+    void draw() const;
+
+    size_t getVertexCount() const { return count_; }
+
+private:
+    GLuint vao_ = 0u;
+    GLuint vbo_ = 0u;
+    size_t capacity_ = 0u;
+    size_t count_ = 0u;
+    bool is_persistent_ = false;
+    GLfloat* p_mapped_ = nullptr;
+
+    GLuint createBuffer(size_t capacity);
+    void attachBuffer(GLuint vbo, size_t capacity);
+};
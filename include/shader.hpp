@@ -6,3 +6,11 @@
 
 GLuint LoadShader(GLenum type, const std::string& path);
 GLuint LoadProgram(const std::vector<GLuint> shaders);
+
+// Split versions of the above. The Begin calls only submit work, so a driver
+// that compiles in the background can overlap it with other setup until the
+// matching Finish call checks the result.
+GLuint BeginLoadShader(GLenum type, const std::string& path);
+void FinishLoadShader(GLuint shader, const std::string& path);
+GLuint BeginLoadProgram(const std::vector<GLuint>& shaders);
+void FinishLoadProgram(GLuint program, const std::vector<GLuint>& shaders);
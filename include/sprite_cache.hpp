@@ -0,0 +1,59 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Caches rasterized tile images in a texture atlas. Slots are handed out on
+// demand and recycled least-recently-used first. The atlas is (re)built by
+// resize, which also drops every cached image. With samples > 0 a slot is
+// drawn into a multisampled buffer the size of one sprite and resolved into
+// the atlas on unbind, so sprites come out antialiased.
+class SpriteCache
+{
+public:
+    SpriteCache(int slots_per_side, int samples);
+
+    void resize(int sprite_size);
+    void destroy();
+
+    void beginFrame();
+    int acquireSlot(unsigned long long key, bool& r_needs_render);
+    glm::vec4 getSlotRect(int slot) const;
+
+    void bindSlot(int slot);
+    void unbindSlot();
+
+    int getSpriteSize() const { return sprite_size_; }
+    GLuint getTexture() const { return texture_; }
+
+private:
+    struct Entry
+    {
+        unsigned long long key;
+        unsigned frame;
+    };
+
+    int sprite_size_ = 0;
+    int slots_per_side_;
+    int requested_samples_;
+    int samples_ = 0;
+    unsigned frame_ = 0u;
+
+    GLuint texture_ = 0u;
+    GLuint fbo_ = 0u;
+    GLuint msaa_fbo_ = 0u;
+    GLuint msaa_color_ = 0u;
+    GLuint resolve_fbo_ = 0u;
+    GLuint resolve_color_ = 0u;
+    int bound_slot_ = -1;
+    GLint saved_fbo_ = 0;
+    GLint saved_viewport_ [4];
+
+    std::vector<Entry> entries_;
+    std::list<int> lru_;
+    std::vector<std::list<int>::iterator> lru_pos_;
+    std::unordered_map<unsigned long long, int> slot_map_;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+ * Batched training environment for Tangle.
+ *
+ * One TangleEnv hosts a number of independent boards that share a size. The
+ * caller owns every observation and result array and binds them once with
+ * tangle_env_bind; reset and step write straight into them. Reset fills in
+ * everything, and a step only rewrites the entries it changed.
+ *
+ * Per board, the arrays indexed by cell hold width * height entries in
+ * row-major order. A board b's cell c is at index b * width * height + c.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TangleEnv TangleEnv;
+
+enum TangleAction
+{
+    TANGLE_ACTION_ROTATE_LEFT = 0,
+    TANGLE_ACTION_ROTATE_RIGHT = 1,
+    TANGLE_ACTION_ADVANCE = 2
+};
+
+typedef struct TangleEnvBuffers
+{
+    /* Per cell. Matching id in [0, 10395) identifies how the twelve ports
+     * are paired, or -1 where the board has no tile. */
+    int16_t* matching;
+    /* Per cell. Orientation in [0, 6). */
+    uint8_t* orientation;
+    /* Per cell. Bit p is set when local port p lies on a taken path. */
+    uint16_t* taken;
+    /* Per board. Cell of the tile the player is about to enter, or -1 once
+     * the player has left the board. */
+    int32_t* player_cell;
+    /* Per board. Port the player left the previous tile through. */
+    uint8_t* player_port;
+    /* Per board. Reward of the last step: 1 for each tile traversed. */
+    float* rewards;
+    /* Per board. Non-zero once the game has ended. */
+    uint8_t* dones;
+} TangleEnvBuffers;
+
+/* thread_count <= 0 uses one thread per hardware thread. Returns NULL on
+ * failure. */
+TangleEnv* tangle_env_create(int count, int width, int height, int thread_count);
+void tangle_env_destroy(TangleEnv* env);
+
+int tangle_env_count(const TangleEnv* env);
+int tangle_env_cell_count(const TangleEnv* env);
+
+void tangle_env_bind(TangleEnv* env, const TangleEnvBuffers* buffers);
+
+/* Regenerates every board from its seed. */
+void tangle_env_reset(TangleEnv* env, const uint64_t* seeds);
+/* Regenerates a single board, e.g. after it reported done. */
+void tangle_env_reset_one(TangleEnv* env, int index, uint64_t seed);
+
+/* Applies one action per board. Boards that are already done are left alone
+ * and get a reward of 0. */
+void tangle_env_step(TangleEnv* env, const int32_t* actions);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. parallelFor blocks
+// until every index has been processed; the calling thread helps out, and no
+// memory is allocated per call.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    int getThreadCount() const { return static_cast<int>(threads_.size()) + 1; }
+
+    template <typename Function>
+    void parallelFor(int count, const Function& function)
+    {
+        run(count, &InvokeRange<Function>, &function);
+    }
+
+private:
+    typedef void (*RangeFunction)(const void* p_context, int begin, int end);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+    bool is_stopping_ = false;
+    unsigned generation_ = 0u;
+    int busy_workers_ = 0;
+
+    RangeFunction p_function_ = nullptr;
+    const void* p_context_ = nullptr;
+    int count_ = 0;
+    int grain_ = 1;
+    std::atomic<int> next_;
+
+    template <typename Function>
+    static void InvokeRange(const void* p_context, int begin, int end)
+    {
+        const Function& function = *static_cast<const Function*>(p_context);
+        for (int i = begin; i < end; i++)
+        {
+            function(i);
+        }
+    }
+
+    void run(int count, RangeFunction p_function, const void* p_context);
+    void work();
+    void workerLoop();
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <random>
 #include <vector>
 
 enum Direction
@@ -46,11 +47,17 @@ public:
     int getJ() const { return j_; }
     Direction getOrientation() const;
     Position toLocal(Position src) const;
+    Position toLocal(Position src, Direction orientation) const;
     Position toGlobal(Position src) const;
+    Position toGlobal(Position src, Direction orientation) const;
     Position getAdjacentPosition(Position from_pos) const;
     Position getDestination(Position from_pos) const;
+    Position getDestination(Position from_pos, Direction orientation) const;
     Path* getPathAtPosition(Position from_pos);
+    const Path* getPathAtPosition(Position from_pos, Direction orientation) const;
     std::vector<Path>& getPaths();
+    const std::vector<Path>& getPaths() const;
+    unsigned long long getAppearanceKey() const;
 
     void setOrientation(Direction orientation);
     void setCoord(int i, int j) { i_ = i; j_ = j; }
@@ -58,6 +65,7 @@ public:
     void clearPaths();
 
     void randomlyGeneratePaths();
+    void randomlyGeneratePaths(std::mt19937& rand);
 
     bool canRotate() const;
     bool isPathTaken(Position from_pos);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records named points in time relative to construction. Marks may come from
+// any thread.
+class Timeline
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Timeline();
+
+    void mark(const std::string& phase);
+    void report(std::ostream& out) const;
+
+private:
+    Clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, Clock::time_point>> marks_;
+};
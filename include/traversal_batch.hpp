@@ -0,0 +1,60 @@
+#pragma once
+
+#include "board.hpp"
+#include "tile.hpp"
+#include <cstdint>
+#include <vector>
+
+// Advances many independent games in lockstep. Boards are flattened into
+// structure-of-arrays tables so one step of eight games can be done with a
+// handful of AVX2 gathers; machines without AVX2 use the scalar loop.
+//
+// Stepping a game matches pressing space in Game: traverse the current tile,
+// move to the adjacent one, and stop on leaving the board or on reaching a
+// path that is already taken.
+class TraversalBatch
+{
+public:
+    TraversalBatch(int width, int height, int count);
+
+    int getCount() const { return count_; }
+    int getLiveCount() const { return live_; }
+
+    void loadGame(int game, const Board& board, const Tile* p_tile, Position pos);
+
+    void step();
+    int run(int max_steps);
+
+    bool isDone(int game) const { return done_[game] != 0; }
+    int getScore(int game) const { return score_[game]; }
+    int getI(int game) const { return i_[game]; }
+    int getJ(int game) const { return j_[game]; }
+    Position getPosition(int game) const { return static_cast<Position>(pos_[game]); }
+    bool isLocalPortTaken(int game, int i, int j, Position local) const;
+
+    static bool HasSimd();
+    void setUseSimd(bool use_simd) { use_simd_ = use_simd && HasSimd(); }
+
+private:
+    int width_;
+    int height_;
+    int cells_;
+    int count_;
+    int live_ = 0;
+    bool use_simd_;
+
+    // Per game and cell: two words of packed 4-bit local destinations, and a
+    // state word holding taken bits, orientation and a presence flag.
+    std::vector<int32_t> ports_;
+    std::vector<int32_t> state_;
+
+    // Per game.
+    std::vector<int32_t> i_;
+    std::vector<int32_t> j_;
+    std::vector<int32_t> pos_;
+    std::vector<int32_t> score_;
+    std::vector<int32_t> done_;
+
+    void stepScalar(int begin, int end);
+    void stepSimd(int begin, int end);
+};
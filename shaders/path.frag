@@ -3,12 +3,25 @@
 smooth in float v_alpha;
 
 uniform bool is_taken;
+uniform bool is_hint;
+uniform bool is_trail;
+uniform float trail_length;
 
 out vec4 output_color;
 
 void main()
 {
-    if (is_taken)
+    if (is_trail)
+    {
+        // v_alpha counts tiles along the route, so older parts fade out.
+        float progress = v_alpha / max(trail_length, 1);
+        output_color = vec4(mix(vec3(0.35, 0, 0), vec3(1, 0.2, 0.2), progress), 1);
+    }
+    else if (is_hint)
+    {
+        output_color = vec4(0, 0.6, 1, 1);
+    }
+    else if (is_taken)
     {
         output_color = vec4(1, 0, 0, 1);
     }
@@ -0,0 +1,19 @@
+#version 330 core
+
+smooth in vec2 v_tex_coord;
+
+uniform sampler2D atlas;
+uniform float alpha_cutoff;
+
+out vec4 output_color;
+
+void main()
+{
+    vec4 color = texture(atlas, v_tex_coord);
+    if (color.a < alpha_cutoff)
+        discard;
+    // Sprites are drawn over a transparent clear, so the edge of the hex
+    // holds colour scaled by coverage. Alpha to coverage turns the alpha back
+    // into coverage when the target is multisampled.
+    output_color = vec4(color.rgb / color.a, color.a);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 tex_coord;
+
+uniform mat4 world_view;
+
+smooth out vec2 v_tex_coord;
+
+void main()
+{
+    gl_Position = world_view * vec4(position, 0, 1);
+    v_tex_coord = tex_coord;
+}
@@ -0,0 +1,283 @@
+#include "analytics.hpp"
+#include "board.hpp"
+#include "traversal_batch.hpp"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+// Bumped whenever the model changes so stale cache files are ignored.
+static const int ANALYSIS_VERSION = 3;
+static const double NEGLIGIBLE_MASS = 1e-15;
+static const int PLAYOUT_CHUNK = 1024;
+static const unsigned PLAYOUT_SEED = 1u;
+
+static void EnumerateMatchings(int partner [POS_LAST], std::vector<Tile>& r_tiles)
+{
+    int first = 0;
+    while (first < POS_LAST && partner[first] >= 0)
+    {
+        first++;
+    }
+    if (first == POS_LAST)
+    {
+        Tile tile;
+        for (int p = 0; p < POS_LAST; p++)
+        {
+            if (p < partner[p])
+                tile.addPath(static_cast<Position>(p), static_cast<Position>(partner[p]));
+        }
+        r_tiles.push_back(tile);
+        return;
+    }
+    for (int q = first + 1; q < POS_LAST; q++)
+    {
+        if (partner[q] >= 0)
+            continue;
+        partner[first] = q;
+        partner[q] = first;
+        EnumerateMatchings(partner, r_tiles);
+        partner[first] = -1;
+        partner[q] = -1;
+    }
+}
+
+TileStatistics ComputeTileStatistics(ThreadPool& pool)
+{
+    // randomlyGeneratePaths pairs up consecutive entries of a uniform shuffle
+    // of the twelve ports. Each matching comes from the same number of
+    // shuffles (6! orders of the pairs times 2^6 orders within them), so all
+    // matchings are equally likely.
+    std::vector<Tile> tiles;
+    int partner [POS_LAST];
+    std::fill(partner, partner + POS_LAST, -1);
+    EnumerateMatchings(partner, tiles);
+
+    TileStatistics stats;
+    stats.matching_count = static_cast<int>(tiles.size());
+    double weight = 1.0 / (tiles.size() * DIR_LAST);
+    pool.parallelFor(POS_LAST, [&] (int from) {
+        double* row = stats.transition[from];
+        std::fill(row, row + POS_LAST, 0.0);
+        for (Tile tile : tiles)
+        {
+            for (int orientation = 0; orientation < DIR_LAST; orientation++)
+            {
+                tile.setOrientation(static_cast<Direction>(orientation));
+                row[tile.getDestination(static_cast<Position>(from))] += weight;
+            }
+        }
+    });
+    return stats;
+}
+
+ScoreAnalysis AnalyzeScore(const TileStatistics& stats, int width, int height, int max_score, ThreadPool& pool)
+{
+    ScoreAnalysis analysis;
+    analysis.width = width;
+    analysis.height = height;
+    analysis.max_score = max_score;
+    analysis.chain_score = 0.0;
+    analysis.tail_probability = 0.0;
+    analysis.distribution.assign(max_score + 1, 0.0);
+    analysis.playout_count = 0;
+    analysis.measured_score = 0.0;
+
+    // Lay out the board exactly as the game does, and use it to find which
+    // cell each cell's ports lead into (-1 for off the board).
+    int cells = width * height;
+    std::vector<Tile> tiles (cells);
+    Board board (width, height);
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            if (board.isInHexShape(i, j))
+                board.setTile(&tiles[i * width + j], i, j);
+        }
+    }
+    std::vector<int> neighbour (cells * DIR_LAST, -1);
+    for (int cell = 0; cell < cells; cell++)
+    {
+        for (int dir = 0; dir < DIR_LAST; dir++)
+        {
+            const Tile* p_next = board.getTileInDirection(static_cast<Direction>(dir), cell / width, cell % width);
+            if (p_next)
+                neighbour[cell * DIR_LAST + dir] = p_next->getI() * width + p_next->getJ();
+        }
+    }
+
+    // mass[cell * POS_LAST + p] is the chance of being about to enter cell
+    // having left the previous tile through port p.
+    std::vector<double> mass (cells * POS_LAST, 0.0);
+    std::vector<double> next_mass (cells * POS_LAST, 0.0);
+    std::vector<double> exited (cells, 0.0);
+    const Tile* p_start = board.getTile(height / 2, width / 2);
+    if (!p_start)
+    {
+        analysis.distribution[0] = 1.0;
+        return analysis;
+    }
+    mass[(p_start->getI() * width + p_start->getJ()) * POS_LAST + POS_NORTH_EAST_0] = 1.0;
+
+    double remaining = 1.0;
+    for (int score = 1; score <= max_score && remaining > NEGLIGIBLE_MASS; score++)
+    {
+        // Each (cell, port) has exactly one predecessor cell, so every worker
+        // pulls into its own cells and no writes are shared.
+        pool.parallelFor(cells, [&] (int cell) {
+            double* p_next_mass = &next_mass[cell * POS_LAST];
+            std::fill(p_next_mass, p_next_mass + POS_LAST, 0.0);
+            for (int q = 0; q < POS_LAST; q++)
+            {
+                int dir = q / 2;
+                int source = neighbour[cell * DIR_LAST + (dir + DIR_LAST / 2) % DIR_LAST];
+                // Cells without a tile still list their neighbours, but
+                // nothing ever moves into them.
+                if (source < 0 || neighbour[source * DIR_LAST + dir] != cell)
+                    continue;
+                const double* p_mass = &mass[source * POS_LAST];
+                double sum = 0.0;
+                for (int p = 0; p < POS_LAST; p++)
+                {
+                    sum += p_mass[p] * stats.transition[p][q];
+                }
+                p_next_mass[q] = sum;
+            }
+            double sum = 0.0;
+            const double* p_mass = &mass[cell * POS_LAST];
+            for (int q = 0; q < POS_LAST; q++)
+            {
+                if (neighbour[cell * DIR_LAST + q / 2] >= 0)
+                    continue;
+                for (int p = 0; p < POS_LAST; p++)
+                {
+                    sum += p_mass[p] * stats.transition[p][q];
+                }
+            }
+            exited[cell] = sum;
+        });
+        double exited_total = 0.0;
+        for (double value : exited)
+        {
+            exited_total += value;
+        }
+        analysis.distribution[score] = exited_total;
+        analysis.chain_score += score * exited_total;
+        remaining -= exited_total;
+        mass.swap(next_mass);
+    }
+    analysis.tail_probability = remaining > 0.0 ? remaining : 0.0;
+    return analysis;
+}
+
+double MeasureMeanScore(int width, int height, int playout_count, ThreadPool& pool)
+{
+    // Chunks are seeded by index, so the result does not depend on the
+    // number of threads.
+    int chunk_count = (playout_count + PLAYOUT_CHUNK - 1) / PLAYOUT_CHUNK;
+    std::vector<long long> totals (chunk_count, 0);
+    pool.parallelFor(chunk_count, [&] (int chunk) {
+        int count = std::min(PLAYOUT_CHUNK, playout_count - chunk * PLAYOUT_CHUNK);
+        std::mt19937 rand (PLAYOUT_SEED + chunk);
+        std::vector<Tile> tiles (width * height);
+        Board board (width, height);
+        TraversalBatch batch (width, height, count);
+        for (int game = 0; game < count; game++)
+        {
+            for (int i = 0; i < height; i++)
+            {
+                for (int j = 0; j < width; j++)
+                {
+                    if (!board.isInHexShape(i, j))
+                        continue;
+                    Tile* p_tile = &tiles[i * width + j];
+                    p_tile->randomlyGeneratePaths(rand);
+                    board.setTile(p_tile, i, j);
+                }
+            }
+            batch.loadGame(game, board, board.getTile(height / 2, width / 2), POS_NORTH_EAST_0);
+        }
+        // Every move takes a path, so no game outlasts the paths on the board.
+        batch.run(width * height * POS_LAST / 2 + 1);
+        for (int game = 0; game < count; game++)
+        {
+            totals[chunk] += batch.getScore(game);
+        }
+    });
+    long long total = 0;
+    for (long long chunk_total : totals)
+    {
+        total += chunk_total;
+    }
+    return playout_count > 0 ? static_cast<double>(total) / playout_count : 0.0;
+}
+
+std::string GetScoreAnalysisCachePath(const std::string& cache_dir, int width, int height, int max_score, int playout_count)
+{
+    std::ostringstream path;
+    path << cache_dir << "/score-v" << ANALYSIS_VERSION << "-" << width << "x" << height << "-" << max_score
+         << "-p" << playout_count << ".txt";
+    return path.str();
+}
+
+// Every value in the cache file follows its name, so the file says which
+// score is the chain's approximation and which was measured.
+template <typename Value>
+static bool ReadField(std::istream& in, const std::string& name, Value& r_value)
+{
+    std::string label;
+    in >> label >> r_value;
+    return in && label == name;
+}
+
+bool LoadScoreAnalysis(const std::string& path, ScoreAnalysis& r_analysis)
+{
+    std::ifstream file (path);
+    if (!file.is_open())
+        return false;
+    int version = 0;
+    if (!ReadField(file, "version", version) || version != ANALYSIS_VERSION)
+        return false;
+    ScoreAnalysis analysis;
+    if (!ReadField(file, "width", analysis.width)
+            || !ReadField(file, "height", analysis.height)
+            || !ReadField(file, "max_score", analysis.max_score)
+            || !ReadField(file, "approximate_chain_score", analysis.chain_score)
+            || !ReadField(file, "tail_probability", analysis.tail_probability)
+            || !ReadField(file, "playout_count", analysis.playout_count)
+            || !ReadField(file, "measured_mean_score", analysis.measured_score)
+            || analysis.max_score < 0)
+        return false;
+    analysis.distribution.resize(analysis.max_score + 1);
+    for (double& probability : analysis.distribution)
+    {
+        file >> probability;
+    }
+    if (!file)
+        return false;
+    r_analysis = analysis;
+    return true;
+}
+
+bool SaveScoreAnalysis(const std::string& path, const ScoreAnalysis& analysis)
+{
+    std::ofstream file (path);
+    if (!file.is_open())
+        return false;
+    file.precision(std::numeric_limits<double>::max_digits10);
+    file << "version " << ANALYSIS_VERSION << "\n"
+         << "width " << analysis.width << "\n"
+         << "height " << analysis.height << "\n"
+         << "max_score " << analysis.max_score << "\n"
+         << "approximate_chain_score " << analysis.chain_score << "\n"
+         << "tail_probability " << analysis.tail_probability << "\n"
+         << "playout_count " << analysis.playout_count << "\n"
+         << "measured_mean_score " << analysis.measured_score << "\n";
+    for (double probability : analysis.distribution)
+    {
+        file << probability << "\n";
+    }
+    return static_cast<bool>(file);
+}
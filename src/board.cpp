@@ -1,4 +1,5 @@
 #include "board.hpp"
+#include <algorithm>
 
 Board::Board(int width, int height)
     : width_ (width)
@@ -23,6 +24,19 @@ bool Board::isOnGrid(int i, int j) const
     return valid_i && valid_j;
 }
 
+bool Board::isInHexShape(int i, int j) const
+{
+    // The grid is skewed, so a hexagonal board leaves out two opposite corners.
+    int cut = (std::min(width_, height_) - 1) / 2;
+    if (!isOnGrid(i, j))
+        return false;
+    if (i + j < cut)
+        return false;
+    if (width_ + height_ - i - j - 2 < cut)
+        return false;
+    return true;
+}
+
 Tile* Board::getTile(int i, int j) const
 {
     if (!isOnGrid(i, j))
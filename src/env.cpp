@@ -0,0 +1,205 @@
+#include "tangle_env.h"
+#include "board.hpp"
+#include "thread_pool.hpp"
+#include "tile.hpp"
+#include <exception>
+#include <random>
+#include <vector>
+
+struct TangleEnv
+{
+    TangleEnv(int count, int width, int height, int thread_count)
+        : count (count)
+        , cells (width * height)
+        , tiles (count * width * height)
+        , boards (count, Board(width, height))
+        , player_tiles (count, nullptr)
+        , player_positions (count, POS_NORTH_EAST_0)
+        , dones (count, 1u)
+        , rands (count)
+        , pool (thread_count)
+    { }
+
+    int count;
+    int cells;
+    std::vector<Tile> tiles;
+    std::vector<Board> boards;
+    std::vector<Tile*> player_tiles;
+    std::vector<Position> player_positions;
+    // Game-over state lives here; buffers.dones is only ever written, so a
+    // caller clearing it cannot make a finished board step again.
+    std::vector<uint8_t> dones;
+    std::vector<std::mt19937> rands;
+    ThreadPool pool;
+    TangleEnvBuffers buffers = {};
+};
+
+// Ranks the perfect matching of the twelve local ports: repeatedly take the
+// lowest free port and record which of the remaining free ports it pairs with.
+static int16_t GetMatchingId(const Tile& tile)
+{
+    int partner [POS_LAST];
+    for (const Path& path : tile.getPaths())
+    {
+        partner[path.begin] = path.end;
+        partner[path.end] = path.begin;
+    }
+    bool used [POS_LAST] = {};
+    int id = 0;
+    for (int p = 0; p < POS_LAST; p++)
+    {
+        if (used[p])
+            continue;
+        int rank = 0;
+        int radix = 0;
+        for (int q = p + 1; q < POS_LAST; q++)
+        {
+            if (used[q])
+                continue;
+            if (q < partner[p])
+                rank++;
+            radix++;
+        }
+        id = id * radix + rank;
+        used[p] = true;
+        used[partner[p]] = true;
+    }
+    return static_cast<int16_t>(id);
+}
+
+static uint16_t GetTakenBits(const Tile& tile)
+{
+    uint16_t bits = 0u;
+    for (const Path& path : tile.getPaths())
+    {
+        if (path.taken)
+            bits |= (1u << path.begin) | (1u << path.end);
+    }
+    return bits;
+}
+
+static void WritePlayer(TangleEnv* env, int index)
+{
+    Tile* p_tile = env->player_tiles[index];
+    const Board& board = env->boards[index];
+    env->buffers.player_cell[index] = p_tile ? p_tile->getI() * board.getWidth() + p_tile->getJ() : -1;
+    env->buffers.player_port[index] = static_cast<uint8_t>(env->player_positions[index]);
+    env->dones[index] = !p_tile || p_tile->isPathTaken(env->player_positions[index]);
+    env->buffers.dones[index] = env->dones[index];
+}
+
+static void ResetBoard(TangleEnv* env, int index, uint64_t seed)
+{
+    std::mt19937& rand = env->rands[index];
+    rand.seed(static_cast<std::mt19937::result_type>(seed ^ (seed >> 32)));
+    Board& board = env->boards[index];
+    int base = index * env->cells;
+    for (int i = 0; i < board.getHeight(); i++)
+    {
+        for (int j = 0; j < board.getWidth(); j++)
+        {
+            int cell = i * board.getWidth() + j;
+            if (!board.isInHexShape(i, j))
+            {
+                env->buffers.matching[base + cell] = -1;
+                env->buffers.orientation[base + cell] = 0u;
+                env->buffers.taken[base + cell] = 0u;
+                continue;
+            }
+            Tile* p_tile = &env->tiles[base + cell];
+            p_tile->setOrientation(DIR_NORTH_EAST);
+            p_tile->randomlyGeneratePaths(rand);
+            board.setTile(p_tile, i, j);
+            env->buffers.matching[base + cell] = GetMatchingId(*p_tile);
+            env->buffers.orientation[base + cell] = DIR_NORTH_EAST;
+            env->buffers.taken[base + cell] = 0u;
+        }
+    }
+    env->player_positions[index] = POS_NORTH_EAST_0;
+    env->player_tiles[index] = board.getTile(board.getHeight() / 2, board.getWidth() / 2);
+    env->buffers.rewards[index] = 0.f;
+    WritePlayer(env, index);
+}
+
+static void StepBoard(TangleEnv* env, int index, int32_t action)
+{
+    env->buffers.rewards[index] = 0.f;
+    if (env->dones[index])
+        return;
+    Tile* p_tile = env->player_tiles[index];
+    int cell = index * env->cells + p_tile->getI() * env->boards[index].getWidth() + p_tile->getJ();
+    switch (action)
+    {
+    case TANGLE_ACTION_ROTATE_LEFT:
+        if (p_tile->canRotate())
+            p_tile->rotateLeft();
+        env->buffers.orientation[cell] = p_tile->getOrientation();
+        break;
+    case TANGLE_ACTION_ROTATE_RIGHT:
+        if (p_tile->canRotate())
+            p_tile->rotateRight();
+        env->buffers.orientation[cell] = p_tile->getOrientation();
+        break;
+    case TANGLE_ACTION_ADVANCE:
+        env->player_positions[index] = p_tile->traverse(env->player_positions[index]);
+        env->player_tiles[index] = env->boards[index].getTileInAdjacentPosition(
+                env->player_positions[index], p_tile->getI(), p_tile->getJ());
+        env->buffers.taken[cell] = GetTakenBits(*p_tile);
+        env->buffers.rewards[index] = 1.f;
+        WritePlayer(env, index);
+        break;
+    }
+}
+
+TangleEnv* tangle_env_create(int count, int width, int height, int thread_count)
+{
+    if (count <= 0 || width <= 0 || height <= 0)
+        return nullptr;
+    try
+    {
+        return new TangleEnv(count, width, height, thread_count);
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+void tangle_env_destroy(TangleEnv* env)
+{
+    delete env;
+}
+
+int tangle_env_count(const TangleEnv* env)
+{
+    return env->count;
+}
+
+int tangle_env_cell_count(const TangleEnv* env)
+{
+    return env->cells;
+}
+
+void tangle_env_bind(TangleEnv* env, const TangleEnvBuffers* buffers)
+{
+    env->buffers = *buffers;
+}
+
+void tangle_env_reset(TangleEnv* env, const uint64_t* seeds)
+{
+    env->pool.parallelFor(env->count, [env, seeds] (int index) {
+        ResetBoard(env, index, seeds[index]);
+    });
+}
+
+void tangle_env_reset_one(TangleEnv* env, int index, uint64_t seed)
+{
+    ResetBoard(env, index, seed);
+}
+
+void tangle_env_step(TangleEnv* env, const int32_t* actions)
+{
+    env->pool.parallelFor(env->count, [env, actions] (int index) {
+        StepBoard(env, index, actions[index]);
+    });
+}
@@ -2,6 +2,9 @@
 #include "game.hpp"
 #include "shader.hpp"
 #include "bezier.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -15,6 +18,23 @@ static const int BOARD_HEIGHT = 9;
 
 static const float SQRT3_OVER_2 = 0.866025;
 static const float BOARD_SCALE = 32.0f;
+static const float TILE_SPACING = 1.1f;
+
+static const int SPRITE_SLOTS_PER_SIDE = 32;
+static const int SPRITE_SAMPLES = 4;
+static const float SPRITE_EXTENT = 1.05f;
+// Single-sample targets cut the sprite edge at half coverage; multisampled
+// ones only drop texels too faint to divide by.
+static const float SPRITE_ALPHA_CUTOFF = 0.5f;
+static const float SPRITE_COVERAGE_CUTOFF = 0.01f;
+
+static const std::chrono::microseconds HINT_FRAME_BUDGET (1000);
+
+static const size_t MAX_FRAMES_IN_FLIGHT = 1;
+static const GLuint64 FENCE_TIMEOUT_NS = 100000000ull;
+static const int LATENCY_BUCKETS = 100;
+
+static const float FRAME_TIME_BUDGET_MS = 12.f;
 
 static int next_tile = 0;
 static Tile tile_pool [BOARD_WIDTH * BOARD_HEIGHT];
@@ -64,11 +84,50 @@ static const std::vector<glm::vec2> TILE_POSITIONS = {
     Vec2Lerp(TILE_VERTICES[5], TILE_VERTICES[0], 0.7f)
 };
 
+static const std::vector<glm::vec2> SPRITE_CORNERS = {
+    glm::vec2 {-1.f, -1.f},
+    glm::vec2 {1.f, -1.f},
+    glm::vec2 {1.f, 1.f},
+    glm::vec2 {-1.f, -1.f},
+    glm::vec2 {1.f, 1.f},
+    glm::vec2 {-1.f, 1.f}
+};
+
+static glm::vec2 GetTileCenter(const Board& board, int i, int j)
+{
+    float half_width = (board.getWidth() - 1) / 2.f;
+    float half_height = (board.getHeight() - 1) / 2.f;
+    float x = (j - half_width) * 1.5;
+    float y = ((half_height - i) * 2 - (j - half_width)) * SQRT3_OVER_2;
+    return glm::vec2 {x, y} * TILE_SPACING;
+}
+
+static const void* GetIndexOffset(const PackedRange& range)
+{
+    return reinterpret_cast<const void*>(range.first * sizeof(GLushort));
+}
+
 Game::Game(int width, int height)
     : board_ (BOARD_WIDTH, BOARD_HEIGHT)
+    , hint_solver_ (board_)
+    , sprite_cache_ (SPRITE_SLOTS_PER_SIDE, SPRITE_SAMPLES)
+    , swap_latency_ (LATENCY_BUCKETS)
+    , finish_latency_ (LATENCY_BUCKETS)
+    , resolution_scaler_ (FRAME_TIME_BUDGET_MS)
 {
-    if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+    // Video brings up the event subsystem too; nothing else is used.
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
         FatalError("Failed to initialize SDL.");
+    startup_.mark("SDL initialized");
+    // Neither of these touch GL, so they can run while the context comes up.
+    board_ready_ = std::async(std::launch::async, [this] {
+        setupBoard();
+        startup_.mark("board generated (worker)");
+    });
+    meshes_ready_ = std::async(std::launch::async, [this] {
+        buildMeshes();
+        startup_.mark("geometry built (worker)");
+    });
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -77,16 +136,38 @@ Game::Game(int width, int height)
             SDL_WINDOWPOS_CENTERED,
             SDL_WINDOWPOS_CENTERED,
             width, height,
-            SDL_WINDOW_OPENGL);
+            SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
     if (!p_window_)
         FatalError("Failed to create SDL window.");
     SDL_GLContext context = SDL_GL_CreateContext(p_window_);
     if (!context)
         FatalError("Failed to initialize SDL context.");
+    startup_.mark("window and context created");
     glewExperimental = true;
     if (glewInit() != GLEW_OK)
         FatalError("Failed to initialize GLEW.");
     glGetError();
+    startup_.mark("GLEW initialized");
+    resize(width, height);
+}
+
+Game::~Game()
+{
+    SDL_DestroyWindow(p_window_);
+    SDL_Quit();
+}
+
+void Game::setLowLatency(bool is_low_latency, int render_delay_ms)
+{
+    is_low_latency_ = is_low_latency;
+    render_delay_ms_ = render_delay_ms;
+}
+
+void Game::resize(int width, int height)
+{
+    window_width_ = width;
+    window_height_ = height;
+    SDL_GL_GetDrawableSize(p_window_, &drawable_width_, &drawable_height_);
     int half_width = width / 2;
     int half_height = height / 2;
     view_ = glm::ortho(
@@ -95,30 +176,83 @@ Game::Game(int width, int height)
             static_cast<float>(-half_height),
             static_cast<float>(height - half_height),
             -1.0f, 1.0f);
-    glViewport(0, 0, width, height);
+    is_target_dirty_ = true;
 }
 
-Game::~Game()
+void Game::resizeRenderTarget()
 {
-    SDL_DestroyWindow(p_window_);
-    SDL_Quit();
+    float scale = resolution_scaler_.getScale();
+    int width = std::max(1, static_cast<int>(drawable_width_ * scale));
+    int height = std::max(1, static_cast<int>(drawable_height_ * scale));
+    render_target_.resize(width, height, resolution_scaler_.getSamples());
+    // One atlas texel per render target pixel, so sprites are not stretched
+    // on high-DPI drawables or smeared at reduced render scales.
+    float pixels_per_unit = BOARD_SCALE * scale * drawable_width_ / std::max(window_width_, 1);
+    sprite_cache_.resize(static_cast<int>(std::ceil(2.f * SPRITE_EXTENT * pixels_per_unit)));
+    is_target_dirty_ = false;
 }
 
 void Game::run()
 {
     setupShaders();
+    startup_.mark("shaders submitted");
+    meshes_ready_.get();
     setupMeshes();
-    setupBoard();
+    startup_.mark("meshes uploaded");
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    resolution_scaler_.setup(max_samples);
+    resizeRenderTarget();
+    route_trail_.setup();
+    finishShaders();
+    startup_.mark("shaders linked");
+    board_ready_.get();
+    startup_.mark("board ready");
+    bool is_first_frame = true;
     is_running_ = true;
     while (is_running_)
     {
+        if (is_low_latency_)
+            waitForFramesInFlight();
+        else
+            pollFramesInFlight(false);
+        HintSolver::Clock::time_point frame_start = HintSolver::Clock::now();
         if (GLint error = glGetError())
             std::cerr << "GL Error (" << error << ")" << std::endl;
+        if (is_target_dirty_)
+            resizeRenderTarget();
+        resolution_scaler_.beginFrame();
+        render_target_.bind();
         glClearColor(0.f, 0.f, 0.f, 0.f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        processInput();
+        // In low latency mode input is read after everything that does not
+        // depend on it, right before the board is drawn.
+        if (!is_low_latency_)
+            processInput();
+        updateHint(frame_start);
+        if (is_low_latency_)
+            processInput();
         drawBoard();
+        render_target_.resolve(drawable_width_, drawable_height_);
+        if (resolution_scaler_.endFrame())
+            is_target_dirty_ = true;
         SDL_GL_SwapWindow(p_window_);
+        Uint32 swap_ticks = SDL_GetTicks();
+        for (Uint32 input_ticks : frame_input_ticks_)
+        {
+            swap_latency_.addSample(swap_ticks - input_ticks);
+        }
+        // Returning from the swap only means the frame was queued; its inputs
+        // are counted again once the fence behind it signals.
+        frames_in_flight_.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), frame_input_ticks_});
+        frame_input_ticks_.clear();
+        if (is_first_frame)
+        {
+            startup_.mark("first frame swapped");
+            std::cout << "Startup:" << std::endl;
+            startup_.report(std::cout);
+            is_first_frame = false;
+        }
         if (!player_tile_) 
         {
             std::cout << "Out of Bounds." << std::endl;
@@ -131,30 +265,55 @@ void Game::run()
         }
     }
     std::cout << "Final Score: " << score << std::endl;
+    pollFramesInFlight(true);
+    std::cout << "Input latency (event to swap call returning):" << std::endl;
+    swap_latency_.report(std::cout);
+    std::cout << "Input latency (event to frame finished on the GPU):" << std::endl;
+    finish_latency_.report(std::cout);
+    render_target_.destroy();
+    resolution_scaler_.destroy();
+    route_trail_.destroy();
     destroyMeshes();
     destroyShaders();
 }
 
-void Game::setupShaders()
+void Game::beginProgram(GLuint* p_program, const std::string& vertex_path, const std::string& fragment_path)
 {
-    std::vector<GLuint> base_shaders = {
-        LoadShader(GL_VERTEX_SHADER, "shaders/base.vert"),
-        LoadShader(GL_FRAGMENT_SHADER, "shaders/base.frag")
+    PendingProgram pending;
+    pending.p_program = p_program;
+    pending.shaders = {
+        BeginLoadShader(GL_VERTEX_SHADER, vertex_path),
+        BeginLoadShader(GL_FRAGMENT_SHADER, fragment_path)
     };
-    base_program_ = LoadProgram(base_shaders);
-    for (GLuint shader : base_shaders)
-    {
-        glDeleteShader(shader);
-    }
-    std::vector<GLuint> path_shaders = {
-        LoadShader(GL_VERTEX_SHADER, "shaders/path.vert"),
-        LoadShader(GL_FRAGMENT_SHADER, "shaders/path.frag")
-    };
-    path_program_ = LoadProgram(path_shaders);
-    for (GLuint shader : path_shaders)
+    pending.paths = {vertex_path, fragment_path};
+    *p_program = BeginLoadProgram(pending.shaders);
+    pending_programs_.push_back(pending);
+}
+
+void Game::setupShaders()
+{
+    if (GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    beginProgram(&base_program_, "shaders/base.vert", "shaders/base.frag");
+    beginProgram(&path_program_, "shaders/path.vert", "shaders/path.frag");
+    beginProgram(&sprite_program_, "shaders/sprite.vert", "shaders/sprite.frag");
+}
+
+void Game::finishShaders()
+{
+    for (const PendingProgram& pending : pending_programs_)
     {
-        glDeleteShader(shader);
+        for (size_t i = 0; i < pending.shaders.size(); i++)
+        {
+            FinishLoadShader(pending.shaders[i], pending.paths[i]);
+        }
+        FinishLoadProgram(*pending.p_program, pending.shaders);
+        for (GLuint shader : pending.shaders)
+        {
+            glDeleteShader(shader);
+        }
     }
+    pending_programs_.clear();
 }
 
 void Game::destroyShaders()
@@ -163,75 +322,105 @@ void Game::destroyShaders()
         glDeleteProgram(base_program_);
     if (path_program_)
         glDeleteProgram(path_program_);
+    if (sprite_program_)
+        glDeleteProgram(sprite_program_);
 }
 
-void Game::setupMeshes()
+void Game::buildMeshes()
 {
-    glGenVertexArrays(1, &tile_vao_);
-    glGenBuffers(1, &tile_vbo_);
-    std::vector<GLfloat> tile_vertex_buffer = {
-        0.f, 0.f,
-        TILE_VERTICES[0].x, TILE_VERTICES[0].y,
-        TILE_VERTICES[1].x, TILE_VERTICES[1].y,
-        TILE_VERTICES[2].x, TILE_VERTICES[2].y,
-        TILE_VERTICES[3].x, TILE_VERTICES[3].y,
-        TILE_VERTICES[4].x, TILE_VERTICES[4].y,
-        TILE_VERTICES[5].x, TILE_VERTICES[5].y,
-        TILE_VERTICES[0].x, TILE_VERTICES[0].y
-    };
-    glBindVertexArray(tile_vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, tile_vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * tile_vertex_buffer.size(), tile_vertex_buffer.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glBindVertexArray(0u);
+    mesh_packer_ = MeshPacker();
+    std::vector<glm::vec2> tile_position_buffer {glm::vec2 {0.f, 0.f}};
+    tile_position_buffer.insert(tile_position_buffer.end(), TILE_VERTICES.begin(), TILE_VERTICES.end());
+    tile_position_buffer.push_back(TILE_VERTICES[0]);
+    int tile_id = mesh_packer_.addPrimitive(tile_position_buffer, std::vector<GLfloat>(tile_position_buffer.size(), 0.f));
 
-    std::vector<GLfloat> path_vertex_buffer;
+    int path_ids [POS_LAST][POS_LAST];
     std::vector<glm::vec2> path_position_buffer;
     std::vector<GLfloat> path_alpha_buffer;
-    int current_offset = 0u;
     for (int i = 0; i < POS_LAST; i++)
     {
         for (int j = i + 1; j < POS_LAST; j++)
         {
             path_position_buffer.clear();
             path_alpha_buffer.clear();
-            int begin_offset = current_offset;
             glm::vec2 p0 = TILE_POSITIONS[i];
             glm::vec2 p3 = TILE_POSITIONS[j];
             glm::vec2 p1 = p0 - 0.3f * TILE_NORMALS[i / 2];
             glm::vec2 p2 = p3 - 0.3f * TILE_NORMALS[j / 2];
             GenBezierCurve({p0, p1, p2, p3}, path_position_buffer, path_alpha_buffer);
-            current_offset += path_position_buffer.size();
-            for (size_t k = 0; k < path_position_buffer.size(); k++)
-            {
-                path_vertex_buffer.push_back(path_position_buffer[k].x);
-                path_vertex_buffer.push_back(path_position_buffer[k].y);
-                path_vertex_buffer.push_back(path_alpha_buffer[k]);
-            }
-            int end_offset = current_offset;
-            path_offsets_[i][j][0] = begin_offset;
-            path_offsets_[i][j][1] = end_offset;
+            path_ids[i][j] = mesh_packer_.addPrimitive(path_position_buffer, path_alpha_buffer);
+        }
+    }
+
+    mesh_packer_.pack();
+    tile_range_ = mesh_packer_.getRange(tile_id);
+    for (int i = 0; i < POS_LAST; i++)
+    {
+        for (int j = i + 1; j < POS_LAST; j++)
+        {
+            path_ranges_[i][j] = mesh_packer_.getRange(path_ids[i][j]);
+        }
+    }
+}
+
+void Game::setupMeshes()
+{
+    const std::vector<PackedVertex>& vertices = mesh_packer_.getVertices();
+    const std::vector<GLushort>& indices = mesh_packer_.getIndices();
+    glGenVertexArrays(1, &mesh_vao_);
+    glGenBuffers(1, &mesh_vbo_);
+    glGenBuffers(1, &mesh_ebo_);
+    glBindVertexArray(mesh_vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(PackedVertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh_ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), 0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(2 * sizeof(GLshort)));
+    glBindVertexArray(0u);
+
+    // Compare against the previous layout: a float xy fan for the tile and
+    // an unindexed float xy-alpha strip per curve.
+    size_t path_vertex_count = 0;
+    for (int i = 0; i < POS_LAST; i++)
+    {
+        for (int j = i + 1; j < POS_LAST; j++)
+        {
+            path_vertex_count += path_ranges_[i][j].count;
         }
     }
-    glGenVertexArrays(1, &path_vao_);
-    glGenBuffers(1, &path_vbo_);
-    glBindVertexArray(path_vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, path_vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * path_vertex_buffer.size(), path_vertex_buffer.data(), GL_STATIC_DRAW);
+    size_t unpacked_bytes = sizeof(GLfloat) * (2 * tile_range_.count + 3 * path_vertex_count);
+    std::cout << "Tile meshes: " << unpacked_bytes << " bytes unpacked, "
+              << mesh_packer_.getPackedBytes() << " bytes packed ("
+              << vertices.size() << " vertices, " << indices.size() << " indices; "
+              << "per tile one fan and up to two path multi-draws)" << std::endl;
+
+    glGenVertexArrays(1, &sprite_vao_);
+    glGenBuffers(1, &sprite_vbo_);
+    glBindVertexArray(sprite_vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, sprite_vbo_);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), 0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), reinterpret_cast<void*>(2 * sizeof(GLfloat)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<void*>(2 * sizeof(GLfloat)));
     glBindVertexArray(0u);
 }
 
 void Game::destroyMeshes()
 {
-    if (tile_vao_)
-        glDeleteVertexArrays(1, &tile_vao_);
-    if (tile_vbo_)
-        glDeleteBuffers(1, &tile_vbo_);
+    if (mesh_vao_)
+        glDeleteVertexArrays(1, &mesh_vao_);
+    if (mesh_vbo_)
+        glDeleteBuffers(1, &mesh_vbo_);
+    if (mesh_ebo_)
+        glDeleteBuffers(1, &mesh_ebo_);
+    if (sprite_vao_)
+        glDeleteVertexArrays(1, &sprite_vao_);
+    if (sprite_vbo_)
+        glDeleteBuffers(1, &sprite_vbo_);
+    sprite_cache_.destroy();
 }
 
 void Game::setupBoard()
@@ -240,9 +429,7 @@ void Game::setupBoard()
     {
         for (int j = 0; j < BOARD_HEIGHT; j++)
         {
-            if (i + j <= 3)
-                continue;
-            if (BOARD_WIDTH + BOARD_HEIGHT - i - j - 2 <= 3)
+            if (!board_.isInHexShape(i, j))
                 continue;
             Tile* p_tile = AllocTile();
             p_tile->randomlyGeneratePaths();
@@ -251,6 +438,48 @@ void Game::setupBoard()
     }
     player_pos_ = static_cast<Position>(0);
     player_tile_ = board_.getTile(BOARD_HEIGHT / 2, BOARD_WIDTH / 2);
+    is_hint_dirty_ = true;
+}
+
+bool Game::retireFrameInFlight(GLuint64 timeout)
+{
+    FrameInFlight& frame = frames_in_flight_.front();
+    GLenum status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (status == GL_TIMEOUT_EXPIRED && timeout == 0u)
+        return false;
+    // A fence that times out while blocking is dropped without a sample.
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+    {
+        Uint32 finish_ticks = SDL_GetTicks();
+        for (Uint32 input_ticks : frame.input_ticks)
+        {
+            finish_latency_.addSample(finish_ticks - input_ticks);
+        }
+    }
+    glDeleteSync(frame.fence);
+    frames_in_flight_.pop_front();
+    return true;
+}
+
+void Game::pollFramesInFlight(bool is_blocking)
+{
+    // Fences signal in submission order, so stop at the first pending one.
+    GLuint64 timeout = is_blocking ? FENCE_TIMEOUT_NS : 0u;
+    while (!frames_in_flight_.empty() && retireFrameInFlight(timeout))
+    { }
+}
+
+void Game::waitForFramesInFlight()
+{
+    pollFramesInFlight(false);
+    while (frames_in_flight_.size() >= MAX_FRAMES_IN_FLIGHT)
+    {
+        retireFrameInFlight(FENCE_TIMEOUT_NS);
+    }
+    // Sleeping here, once the GPU has caught up, moves the input poll closer
+    // to the swap that shows its result.
+    if (render_delay_ms_ > 0)
+        SDL_Delay(render_delay_ms_);
 }
 
 void Game::processInput()
@@ -263,78 +492,224 @@ void Game::processInput()
         case SDL_QUIT:
             is_running_ = false;
             break;
+        case SDL_WINDOWEVENT:
+            if (ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                resize(ev.window.data1, ev.window.data2);
+            break;
         case SDL_KEYDOWN:
+            frame_input_ticks_.push_back(ev.key.timestamp);
             if (ev.key.keysym.sym == SDLK_SPACE)
             {
+                appendTrail(player_tile_, player_pos_);
                 player_pos_ = board_.getTile(player_tile_->getI(), player_tile_->getJ())->traverse(player_pos_);
                 player_tile_ = board_.getTileInAdjacentPosition(player_pos_, player_tile_->getI(), player_tile_->getJ());
                 score++;
+                is_hint_dirty_ = true;
             }
             if (ev.key.keysym.sym == SDLK_LEFT)
             {
                 if (player_tile_->canRotate())
+                {
                     player_tile_->rotateLeft();
+                    is_hint_dirty_ = true;
+                }
             }
             if (ev.key.keysym.sym == SDLK_RIGHT)
             {
                 if (player_tile_->canRotate())
+                {
                     player_tile_->rotateRight();
+                    is_hint_dirty_ = true;
+                }
+            }
+            if (ev.key.keysym.sym == SDLK_h)
+            {
+                is_hint_enabled_ = !is_hint_enabled_;
+                is_hint_dirty_ = true;
             }
         }
     }
 }
 
-void Game::drawBoard()
+void Game::updateHint(HintSolver::Clock::time_point frame_start)
 {
-    GLint world_view_loc = -1;
-    float half_width = (board_.getWidth() - 1) / 2.f;
-    float half_height = (board_.getHeight() - 1) / 2.f;
-    glUseProgram(base_program_);
-    glBindVertexArray(tile_vao_);
-    world_view_loc = glGetUniformLocation(base_program_, "world_view");
-    for (int i = 0; i < board_.getHeight(); i++)
+    if (!is_hint_enabled_)
+        return;
+    if (is_hint_dirty_ && player_tile_)
     {
-        for (int j = 0; j < board_.getWidth(); j++)
-        {
-            Tile* p_tile = board_.getTile(i, j);
-            if (p_tile)
-            {
-                float x = (j - half_width) * 1.5;
-                float y = ((half_height - i) * 2 - (j - half_width)) * SQRT3_OVER_2;
-                x *= 1.1f;
-                y *= 1.1f;
-                glm::mat4 world_view = glm::translate(glm::scale(view_, glm::vec3(BOARD_SCALE, BOARD_SCALE, 1.f)), glm::vec3(x, y, 0.f));
-                glUniformMatrix4fv(world_view_loc, 1, GL_FALSE, glm::value_ptr(world_view));
-                glDrawArrays(GL_TRIANGLE_FAN, 0, 8);
-            }
-        }
+        hint_solver_.restart(player_tile_, player_pos_);
+        is_hint_dirty_ = false;
     }
+    hint_solver_.update(frame_start + HINT_FRAME_BUDGET);
+}
+
+void Game::appendTrail(const Tile* p_tile, Position from_pos)
+{
+    const Path* p_path = p_tile->getPathAtPosition(from_pos, p_tile->getOrientation());
+    if (!p_path)
+        return;
+    // Curves are stored from the lower port to the higher one; walk them
+    // backwards when the player enters at the higher port.
+    Position entry = p_tile->toLocal(p_tile->getAdjacentPosition(from_pos));
+    bool is_forward = entry == p_path->begin;
+    PackedRange range = path_ranges_[p_path->begin][p_path->end];
+    const std::vector<PackedVertex>& vertices = mesh_packer_.getVertices();
+    const std::vector<GLushort>& indices = mesh_packer_.getIndices();
+    glm::vec2 center = GetTileCenter(board_, p_tile->getI(), p_tile->getJ());
+    float angle = glm::pi<float>() / 3 * p_tile->getOrientation();
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    trail_segment_.clear();
+    int previous_index = -1;
+    for (int k = 0; k < range.count; k++)
+    {
+        // GenBezierCurve repeats the point where subdivided halves meet;
+        // drawn as a strip the repeat adds nothing.
+        int index = indices[range.first + (is_forward ? k : range.count - 1 - k)];
+        if (index == previous_index)
+            continue;
+        previous_index = index;
+        const PackedVertex& vertex = vertices[index];
+        glm::vec2 position = MeshPacker::UnpackPosition(vertex);
+        float alpha = MeshPacker::UnpackAlpha(vertex);
+        float t = is_forward ? alpha : 1.f - alpha;
+        trail_segment_.push_back(center.x + position.x * c - position.y * s);
+        trail_segment_.push_back(center.y + position.x * s + position.y * c);
+        trail_segment_.push_back(trail_length_ + t);
+    }
+    route_trail_.append(trail_segment_.data(), trail_segment_.size() / 3);
+    trail_length_++;
+}
+
+void Game::drawTrail(const glm::mat4& board_view)
+{
+    glUseProgram(path_program_);
+    glUniformMatrix4fv(glGetUniformLocation(path_program_, "world_view"), 1, GL_FALSE, glm::value_ptr(board_view));
+    glUniform1i(glGetUniformLocation(path_program_, "is_trail"), true);
+    glUniform1f(glGetUniformLocation(path_program_, "trail_length"), static_cast<float>(trail_length_));
+    route_trail_.draw();
+    glUniform1i(glGetUniformLocation(path_program_, "is_trail"), false);
+}
+
+void Game::drawTile(const Tile* p_tile, const glm::mat4& world_view)
+{
+    glBindVertexArray(mesh_vao_);
+    glUseProgram(base_program_);
+    GLint world_view_loc = glGetUniformLocation(base_program_, "world_view");
+    glUniformMatrix4fv(world_view_loc, 1, GL_FALSE, glm::value_ptr(world_view));
+    glDrawElements(GL_TRIANGLE_FAN, tile_range_.count, GL_UNSIGNED_SHORT, GetIndexOffset(tile_range_));
     glUseProgram(path_program_);
-    glBindVertexArray(path_vao_);
     world_view_loc = glGetUniformLocation(path_program_, "world_view");
     GLint is_taken_loc = glGetUniformLocation(path_program_, "is_taken");
+    glUniformMatrix4fv(world_view_loc, 1, GL_FALSE, glm::value_ptr(world_view));
+    glUniform1i(glGetUniformLocation(path_program_, "is_hint"), false);
+    glUniform1i(glGetUniformLocation(path_program_, "is_trail"), false);
+    // Untaken and taken paths only differ by a uniform, so each group is a
+    // single draw.
+    GLsizei counts [2][POS_LAST / 2];
+    const void* offsets [2][POS_LAST / 2];
+    GLsizei group_sizes [2] = {0, 0};
+    for (const Path& path : p_tile->getPaths())
+    {
+        int group = path.taken ? 1 : 0;
+        PackedRange range = path_ranges_[path.begin][path.end];
+        counts[group][group_sizes[group]] = range.count;
+        offsets[group][group_sizes[group]] = GetIndexOffset(range);
+        group_sizes[group]++;
+    }
+    for (int group = 0; group < 2; group++)
+    {
+        if (group_sizes[group] == 0)
+            continue;
+        glUniform1i(is_taken_loc, group);
+        glMultiDrawElements(GL_LINE_STRIP, counts[group], GL_UNSIGNED_SHORT, offsets[group], group_sizes[group]);
+    }
+}
+
+void Game::drawHint(const glm::mat4& board_view)
+{
+    glUseProgram(path_program_);
+    glBindVertexArray(mesh_vao_);
+    GLint world_view_loc = glGetUniformLocation(path_program_, "world_view");
+    GLint is_hint_loc = glGetUniformLocation(path_program_, "is_hint");
+    glUniform1i(is_hint_loc, true);
+    for (const HintSegment& segment : hint_solver_.getRoute())
+    {
+        glm::vec2 center = GetTileCenter(board_, segment.p_tile->getI(), segment.p_tile->getJ());
+        glm::mat4 world_view = glm::rotate(glm::translate(board_view, glm::vec3(center.x, center.y, 0.f)), glm::pi<float>() / 3 * segment.orientation, glm::vec3(0, 0, 1));
+        glUniformMatrix4fv(world_view_loc, 1, GL_FALSE, glm::value_ptr(world_view));
+        PackedRange range = path_ranges_[segment.path.begin][segment.path.end];
+        glDrawElements(GL_LINE_STRIP, range.count, GL_UNSIGNED_SHORT, GetIndexOffset(range));
+    }
+    glUniform1i(is_hint_loc, false);
+}
+
+void Game::drawBoard()
+{
+    glm::mat4 board_view = glm::scale(view_, glm::vec3(BOARD_SCALE, BOARD_SCALE, 1.f));
+    glm::mat4 sprite_view = glm::ortho(-SPRITE_EXTENT, SPRITE_EXTENT, -SPRITE_EXTENT, SPRITE_EXTENT, -1.f, 1.f);
+    sprite_cache_.beginFrame();
+    sprite_vertex_buffer_.clear();
+    uncached_tiles_.clear();
     for (int i = 0; i < board_.getHeight(); i++)
     {
         for (int j = 0; j < board_.getWidth(); j++)
         {
-            Tile* p_tile = board_.getTile(i, j);
-            if (p_tile)
+            const Tile* p_tile = board_.getTile(i, j);
+            if (!p_tile)
+                continue;
+            bool needs_render = false;
+            int slot = sprite_cache_.acquireSlot(p_tile->getAppearanceKey(), needs_render);
+            if (slot < 0)
             {
-                float x = (j - half_width) * 1.5;
-                float y = ((half_height - i) * 2 - (j - half_width)) * SQRT3_OVER_2;
-                x *= 1.1f;
-                y *= 1.1f;
-                glm::mat4 world_view = glm::rotate(glm::translate(glm::scale(view_, glm::vec3(BOARD_SCALE, BOARD_SCALE, 1.f)), glm::vec3(x, y, 0.f)), glm::pi<float>() / 3 * p_tile->getOrientation(), glm::vec3(0, 0, 1));
-                glUniformMatrix4fv(world_view_loc, 1, GL_FALSE, glm::value_ptr(world_view));
-                for (Path path : p_tile->getPaths())
-                {
-                    glUniform1i(is_taken_loc, path.taken);
-                    GLint offset_begin = path_offsets_[path.begin][path.end][0];
-                    GLint offset_end = path_offsets_[path.begin][path.end][1];
-                    GLint count = offset_end - offset_begin;
-                    glDrawArrays(GL_LINE_STRIP, offset_begin, count);
-                }
+                uncached_tiles_.push_back(p_tile);
+                continue;
+            }
+            if (needs_render)
+            {
+                sprite_cache_.bindSlot(slot);
+                drawTile(p_tile, sprite_view);
+                sprite_cache_.unbindSlot();
+            }
+            // Sprites are rendered unrotated, so orientation is applied to the
+            // quad instead of being part of the cache key.
+            glm::vec2 center = GetTileCenter(board_, i, j);
+            glm::vec4 rect = sprite_cache_.getSlotRect(slot);
+            float angle = glm::pi<float>() / 3 * p_tile->getOrientation();
+            float c = std::cos(angle) * SPRITE_EXTENT;
+            float s = std::sin(angle) * SPRITE_EXTENT;
+            for (const glm::vec2& corner : SPRITE_CORNERS)
+            {
+                sprite_vertex_buffer_.push_back(center.x + corner.x * c - corner.y * s);
+                sprite_vertex_buffer_.push_back(center.y + corner.x * s + corner.y * c);
+                sprite_vertex_buffer_.push_back(corner.x < 0.f ? rect.x : rect.z);
+                sprite_vertex_buffer_.push_back(corner.y < 0.f ? rect.y : rect.w);
             }
         }
     }
+    glUseProgram(sprite_program_);
+    glBindVertexArray(sprite_vao_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sprite_cache_.getTexture());
+    glUniform1i(glGetUniformLocation(sprite_program_, "atlas"), 0);
+    glUniformMatrix4fv(glGetUniformLocation(sprite_program_, "world_view"), 1, GL_FALSE, glm::value_ptr(board_view));
+    bool is_multisampled = render_target_.getSamples() > 0;
+    glUniform1f(glGetUniformLocation(sprite_program_, "alpha_cutoff"), is_multisampled ? SPRITE_COVERAGE_CUTOFF : SPRITE_ALPHA_CUTOFF);
+    if (is_multisampled)
+        glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+    glBindBuffer(GL_ARRAY_BUFFER, sprite_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * sprite_vertex_buffer_.size(), sprite_vertex_buffer_.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, sprite_vertex_buffer_.size() / 4);
+    glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+    for (const Tile* p_tile : uncached_tiles_)
+    {
+        glm::vec2 center = GetTileCenter(board_, p_tile->getI(), p_tile->getJ());
+        glm::mat4 world_view = glm::rotate(glm::translate(board_view, glm::vec3(center.x, center.y, 0.f)), glm::pi<float>() / 3 * p_tile->getOrientation(), glm::vec3(0, 0, 1));
+        drawTile(p_tile, world_view);
+    }
+    drawTrail(board_view);
+    // Input read after updateHint (low latency mode) leaves the solver's
+    // route describing the previous board until the next frame restarts it.
+    if (is_hint_enabled_ && !is_hint_dirty_ && hint_solver_.isFinished())
+        drawHint(board_view);
 }
@@ -0,0 +1,88 @@
+#include "hint_solver.hpp"
+
+// Steps taken between clock reads; small enough that a slice never overruns
+// its deadline by more than a few microseconds.
+static const int STEPS_PER_CLOCK_CHECK = 32;
+
+HintSolver::HintSolver(const Board& board)
+    : board_ (board)
+    , taken_ (board.getWidth() * board.getHeight(), 0)
+{ }
+
+void HintSolver::restart(const Tile* p_start, Position start_pos)
+{
+    p_start_ = p_start;
+    start_pos_ = start_pos;
+    best_route_.clear();
+    best_orientation_ = p_start ? p_start->getOrientation() : DIR_NORTH_EAST;
+    is_finished_ = !p_start;
+    if (is_finished_)
+        return;
+    // A tile that already has a taken path cannot be rotated any more.
+    candidate_count_ = p_start->canRotate() ? DIR_LAST : 1;
+    candidate_ = 0;
+    beginCandidate();
+}
+
+void HintSolver::update(Clock::time_point deadline)
+{
+    while (!is_finished_)
+    {
+        if (Clock::now() >= deadline)
+            return;
+        for (int k = 0; k < STEPS_PER_CLOCK_CHECK && !is_finished_; k++)
+        {
+            if (!advance())
+                endCandidate();
+        }
+    }
+}
+
+void HintSolver::beginCandidate()
+{
+    // Start from the current orientation so ties keep the tile as it is.
+    orientation_ = static_cast<Direction>((p_start_->getOrientation() + candidate_) % DIR_LAST);
+    p_tile_ = p_start_;
+    pos_ = start_pos_;
+    route_.clear();
+}
+
+void HintSolver::endCandidate()
+{
+    if (route_.size() > best_route_.size())
+    {
+        best_route_.swap(route_);
+        best_orientation_ = orientation_;
+    }
+    for (int cell : touched_)
+    {
+        taken_[cell] = 0;
+    }
+    touched_.clear();
+    candidate_++;
+    if (candidate_ >= candidate_count_)
+        is_finished_ = true;
+    else
+        beginCandidate();
+}
+
+bool HintSolver::advance()
+{
+    if (!p_tile_)
+        return false;
+    Direction orientation = (p_tile_ == p_start_) ? orientation_ : p_tile_->getOrientation();
+    const Path* p_path = p_tile_->getPathAtPosition(pos_, orientation);
+    if (!p_path || p_path->taken)
+        return false;
+    int cell = p_tile_->getI() * board_.getWidth() + p_tile_->getJ();
+    unsigned short path_bits = (1u << p_path->begin) | (1u << p_path->end);
+    if (taken_[cell] & path_bits)
+        return false;
+    if (!taken_[cell])
+        touched_.push_back(cell);
+    taken_[cell] |= path_bits;
+    route_.push_back({p_tile_, orientation, *p_path});
+    pos_ = p_tile_->getDestination(pos_, orientation);
+    p_tile_ = board_.getTileInAdjacentPosition(pos_, p_tile_->getI(), p_tile_->getJ());
+    return true;
+}
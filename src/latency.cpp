@@ -0,0 +1,58 @@
+#include "latency.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+static const int REPORT_BAR_WIDTH = 40;
+
+LatencyHistogram::LatencyHistogram(int bucket_count)
+    : buckets_ (bucket_count, 0)
+{ }
+
+void LatencyHistogram::addSample(int milliseconds)
+{
+    milliseconds = std::max(milliseconds, 0);
+    int bucket = std::min(milliseconds, static_cast<int>(buckets_.size()) - 1);
+    buckets_[bucket]++;
+    sample_count_++;
+    total_ += milliseconds;
+    max_ = std::max(max_, milliseconds);
+}
+
+int LatencyHistogram::getPercentile(float fraction) const
+{
+    int target = static_cast<int>(fraction * sample_count_);
+    int seen = 0;
+    for (size_t i = 0; i < buckets_.size(); i++)
+    {
+        seen += buckets_[i];
+        if (seen > target)
+            return i;
+    }
+    return buckets_.size() - 1;
+}
+
+void LatencyHistogram::report(std::ostream& out) const
+{
+    if (!sample_count_)
+    {
+        out << "  no samples" << std::endl;
+        return;
+    }
+    out << "  samples " << sample_count_
+        << ", mean " << total_ / sample_count_ << " ms"
+        << ", p50 " << getPercentile(0.5f) << " ms"
+        << ", p95 " << getPercentile(0.95f) << " ms"
+        << ", p99 " << getPercentile(0.99f) << " ms"
+        << ", max " << max_ << " ms" << std::endl;
+    int peak = *std::max_element(buckets_.begin(), buckets_.end());
+    for (size_t i = 0; i < buckets_.size(); i++)
+    {
+        if (!buckets_[i])
+            continue;
+        int width = std::max(1, buckets_[i] * REPORT_BAR_WIDTH / peak);
+        bool is_last = i + 1 == buckets_.size();
+        out << "  " << std::setw(4) << i << (is_last ? "+" : " ") << "ms "
+            << std::setw(6) << buckets_[i] << " " << std::string(width, '#') << std::endl;
+    }
+}
@@ -1,7 +1,20 @@
 #include "game.hpp"
+#include <cstdlib>
+#include <string>
 
 int main(int argc, char* argv [])
 {
+    bool is_low_latency = false;
+    int render_delay_ms = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg (argv[i]);
+        if (arg == "--low-latency")
+            is_low_latency = true;
+        else if (arg.compare(0, 15, "--render-delay=") == 0)
+            render_delay_ms = std::atoi(arg.c_str() + 15);
+    }
     Game game (800, 600);
+    game.setLowLatency(is_low_latency, render_delay_ms);
     game.run();
 }
@@ -0,0 +1,124 @@
+#include "mesh_packer.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+static GLshort PackSigned(float value)
+{
+    return static_cast<GLshort>(std::lround(glm::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+static GLushort PackUnsigned(float value)
+{
+    return static_cast<GLushort>(std::lround(glm::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+static unsigned long long GetVertexKey(const PackedVertex& vertex)
+{
+    return static_cast<unsigned long long>(static_cast<GLushort>(vertex.x))
+        | static_cast<unsigned long long>(static_cast<GLushort>(vertex.y)) << 16
+        | static_cast<unsigned long long>(vertex.alpha) << 32;
+}
+
+int MeshPacker::addPrimitive(const std::vector<glm::vec2>& positions, const std::vector<GLfloat>& alphas)
+{
+    std::vector<PackedVertex> primitive;
+    for (size_t k = 0; k < positions.size(); k++)
+    {
+        primitive.push_back({PackSigned(positions[k].x), PackSigned(positions[k].y), PackUnsigned(alphas[k]), 0u});
+    }
+    primitives_.push_back(primitive);
+    return primitives_.size() - 1;
+}
+
+void MeshPacker::pack()
+{
+    // Merge vertices that quantize to the same value, e.g. curve endpoints
+    // that meet at the same port.
+    std::unordered_map<unsigned long long, int> unique_ids;
+    std::vector<PackedVertex> unique_vertices;
+    std::vector<std::vector<int>> primitive_ids (primitives_.size());
+    for (size_t p = 0; p < primitives_.size(); p++)
+    {
+        for (const PackedVertex& vertex : primitives_[p])
+        {
+            auto inserted = unique_ids.insert({GetVertexKey(vertex), static_cast<int>(unique_vertices.size())});
+            if (inserted.second)
+                unique_vertices.push_back(vertex);
+            primitive_ids[p].push_back(inserted.first->second);
+        }
+    }
+
+    // Greedily follow each primitive with the remaining one that shares the
+    // most vertices with it, so those vertices are still in the post-transform
+    // cache and nearby in memory.
+    std::vector<int> order;
+    std::vector<bool> is_placed (primitives_.size(), false);
+    std::vector<int> last_use (unique_vertices.size(), -1);
+    for (size_t n = 0; n < primitives_.size(); n++)
+    {
+        int best = -1;
+        int best_shared = -1;
+        for (size_t p = 0; p < primitives_.size(); p++)
+        {
+            if (is_placed[p])
+                continue;
+            int shared = 0;
+            for (int id : primitive_ids[p])
+            {
+                if (!order.empty() && last_use[id] == order.back())
+                    shared++;
+            }
+            if (shared > best_shared)
+            {
+                best = p;
+                best_shared = shared;
+            }
+        }
+        is_placed[best] = true;
+        order.push_back(best);
+        for (int id : primitive_ids[best])
+        {
+            last_use[id] = best;
+        }
+    }
+
+    if (unique_vertices.size() > 0x10000u)
+        FatalError("Packed mesh has too many vertices for 16-bit indices.");
+
+    // Renumber vertices by first use so fetches walk the buffer forwards.
+    std::vector<int> remap (unique_vertices.size(), -1);
+    vertices_.clear();
+    indices_.clear();
+    ranges_.assign(primitives_.size(), PackedRange {0, 0});
+    for (int p : order)
+    {
+        ranges_[p].first = indices_.size();
+        ranges_[p].count = primitive_ids[p].size();
+        for (int id : primitive_ids[p])
+        {
+            if (remap[id] < 0)
+            {
+                remap[id] = vertices_.size();
+                vertices_.push_back(unique_vertices[id]);
+            }
+            indices_.push_back(static_cast<GLushort>(remap[id]));
+        }
+    }
+}
+
+size_t MeshPacker::getPackedBytes() const
+{
+    return vertices_.size() * sizeof(PackedVertex) + indices_.size() * sizeof(GLushort);
+}
+
+glm::vec2 MeshPacker::UnpackPosition(const PackedVertex& vertex)
+{
+    return glm::vec2 {vertex.x / 32767.f, vertex.y / 32767.f};
+}
+
+float MeshPacker::UnpackAlpha(const PackedVertex& vertex)
+{
+    return vertex.alpha / 65535.f;
+}
@@ -0,0 +1,75 @@
+#include "render_target.hpp"
+#include "error.hpp"
+
+void RenderTarget::resize(int width, int height, int samples)
+{
+    destroy();
+    width_ = width;
+    height_ = height;
+    samples_ = samples;
+
+    glGenRenderbuffers(1, &resolve_color_);
+    glBindRenderbuffer(GL_RENDERBUFFER, resolve_color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &resolve_fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, resolve_fbo_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, resolve_color_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        FatalError("Failed to create offscreen framebuffer.");
+
+    if (samples > 0)
+    {
+        glGenRenderbuffers(1, &msaa_color_);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaa_color_);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+        glGenFramebuffers(1, &msaa_fbo_);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaa_color_);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            FatalError("Failed to create multisampled framebuffer.");
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0u);
+}
+
+void RenderTarget::destroy()
+{
+    if (msaa_fbo_)
+        glDeleteFramebuffers(1, &msaa_fbo_);
+    if (msaa_color_)
+        glDeleteRenderbuffers(1, &msaa_color_);
+    if (resolve_fbo_)
+        glDeleteFramebuffers(1, &resolve_fbo_);
+    if (resolve_color_)
+        glDeleteRenderbuffers(1, &resolve_color_);
+    msaa_fbo_ = 0u;
+    msaa_color_ = 0u;
+    resolve_fbo_ = 0u;
+    resolve_color_ = 0u;
+}
+
+void RenderTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_ ? msaa_fbo_ : resolve_fbo_);
+    glViewport(0, 0, width_, height_);
+}
+
+void RenderTarget::resolve(int window_width, int window_height)
+{
+    // Multisampled blits cannot scale, so resolve at full size first.
+    if (msaa_fbo_)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, msaa_fbo_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_fbo_);
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    bool is_scaled = width_ != window_width || height_ != window_height;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolve_fbo_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0u);
+    glBlitFramebuffer(
+            0, 0, width_, height_,
+            0, 0, window_width, window_height,
+            GL_COLOR_BUFFER_BIT, is_scaled ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0u);
+    glViewport(0, 0, window_width, window_height);
+}
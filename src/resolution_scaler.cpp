@@ -0,0 +1,96 @@
+#include "resolution_scaler.hpp"
+#include <algorithm>
+
+struct QualityLevel
+{
+    float scale;
+    int samples;
+};
+
+// Ordered from best to cheapest.
+static const QualityLevel QUALITY_LEVELS [] = {
+    {1.f, 4},
+    {1.f, 2},
+    {1.f, 0},
+    {0.85f, 0},
+    {0.7f, 0},
+    {0.5f, 0}
+};
+static const int QUALITY_LEVEL_COUNT = sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0]);
+
+static const float AVERAGE_WEIGHT = 0.1f;
+static const float RAISE_THRESHOLD = 0.6f;
+// Frames to wait after a change before judging the new level; going back up
+// waits longer so a level that only just fits does not oscillate.
+static const int LOWER_COOLDOWN_FRAMES = 15;
+static const int RAISE_COOLDOWN_FRAMES = 120;
+
+ResolutionScaler::ResolutionScaler(float budget_ms)
+    : budget_ms_ (budget_ms)
+{ }
+
+void ResolutionScaler::setup(int max_samples)
+{
+    max_samples_ = max_samples;
+    glGenQueries(QUERY_COUNT, queries_);
+    level_ = 0;
+    average_ms_ = 0.f;
+    frames_since_change_ = 0;
+    frame_ = 0;
+    is_setup_ = true;
+}
+
+void ResolutionScaler::destroy()
+{
+    if (is_setup_)
+        glDeleteQueries(QUERY_COUNT, queries_);
+    is_setup_ = false;
+}
+
+void ResolutionScaler::beginFrame()
+{
+    glBeginQuery(GL_TIME_ELAPSED, queries_[frame_ % QUERY_COUNT]);
+}
+
+bool ResolutionScaler::endFrame()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    frame_++;
+    frames_since_change_++;
+    if (frame_ < QUERY_COUNT)
+        return false;
+    // The slot about to be reused holds the oldest query still outstanding.
+    GLuint query = queries_[frame_ % QUERY_COUNT];
+    GLint is_available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+    if (!is_available)
+        return false;
+    GLuint64 elapsed_ns = 0u;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+    float elapsed_ms = elapsed_ns / 1e6f;
+    if (frames_since_change_ <= QUERY_COUNT)
+        average_ms_ = elapsed_ms;
+    else
+        average_ms_ += (elapsed_ms - average_ms_) * AVERAGE_WEIGHT;
+
+    int level = level_;
+    if (average_ms_ > budget_ms_ && frames_since_change_ > LOWER_COOLDOWN_FRAMES)
+        level = std::min(level_ + 1, QUALITY_LEVEL_COUNT - 1);
+    else if (average_ms_ < budget_ms_ * RAISE_THRESHOLD && frames_since_change_ > RAISE_COOLDOWN_FRAMES)
+        level = std::max(level_ - 1, 0);
+    if (level == level_)
+        return false;
+    level_ = level;
+    frames_since_change_ = 0;
+    return true;
+}
+
+float ResolutionScaler::getScale() const
+{
+    return QUALITY_LEVELS[level_].scale;
+}
+
+int ResolutionScaler::getSamples() const
+{
+    return std::min(QUALITY_LEVELS[level_].samples, max_samples_);
+}
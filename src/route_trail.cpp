@@ -0,0 +1,101 @@
+#include "route_trail.hpp"
+#include <algorithm>
+#include <cstring>
+
+static const size_t VERTEX_SIZE = 3 * sizeof(GLfloat);
+static const size_t INITIAL_CAPACITY = 4096u;
+static const GLbitfield PERSISTENT_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+void RouteTrail::setup()
+{
+    is_persistent_ = GLEW_ARB_buffer_storage;
+    glGenVertexArrays(1, &vao_);
+    attachBuffer(createBuffer(INITIAL_CAPACITY), INITIAL_CAPACITY);
+    count_ = 0u;
+}
+
+void RouteTrail::destroy()
+{
+    if (vbo_)
+        glDeleteBuffers(1, &vbo_);
+    if (vao_)
+        glDeleteVertexArrays(1, &vao_);
+    vbo_ = 0u;
+    vao_ = 0u;
+    p_mapped_ = nullptr;
+    capacity_ = 0u;
+    count_ = 0u;
+}
+
+void RouteTrail::append(const GLfloat* p_vertices, size_t vertex_count)
+{
+    if (count_ + vertex_count > capacity_)
+    {
+        size_t capacity = std::max(capacity_ * 2, count_ + vertex_count);
+        GLuint old_vbo = vbo_;
+        GLuint new_vbo = createBuffer(capacity);
+        glBindBuffer(GL_COPY_READ_BUFFER, old_vbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, new_vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, count_ * VERTEX_SIZE);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0u);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+        attachBuffer(new_vbo, capacity);
+        glDeleteBuffers(1, &old_vbo);
+    }
+    size_t offset = count_ * VERTEX_SIZE;
+    size_t size = vertex_count * VERTEX_SIZE;
+    if (is_persistent_)
+    {
+        std::memcpy(reinterpret_cast<char*>(p_mapped_) + offset, p_vertices, size);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        void* p_range = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (p_range)
+        {
+            std::memcpy(p_range, p_vertices, size);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0u);
+    }
+    count_ += vertex_count;
+}
+
+void RouteTrail::draw() const
+{
+    if (count_ < 2)
+        return;
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_LINE_STRIP, 0, count_);
+}
+
+GLuint RouteTrail::createBuffer(size_t capacity)
+{
+    GLuint vbo = 0u;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (is_persistent_)
+        glBufferStorage(GL_ARRAY_BUFFER, capacity * VERTEX_SIZE, nullptr, PERSISTENT_FLAGS);
+    else
+        glBufferData(GL_ARRAY_BUFFER, capacity * VERTEX_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0u);
+    return vbo;
+}
+
+void RouteTrail::attachBuffer(GLuint vbo, size_t capacity)
+{
+    vbo_ = vbo;
+    capacity_ = capacity;
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, 0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, VERTEX_SIZE, reinterpret_cast<void*>(2 * sizeof(GLfloat)));
+    if (is_persistent_)
+        p_mapped_ = static_cast<GLfloat*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, capacity * VERTEX_SIZE, PERSISTENT_FLAGS));
+    glBindVertexArray(0u);
+    glBindBuffer(GL_ARRAY_BUFFER, 0u);
+}
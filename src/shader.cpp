@@ -3,6 +3,20 @@
 #include <fstream>
 
 GLuint LoadShader(GLenum type, const std::string& path)
+{
+    GLuint shader = BeginLoadShader(type, path);
+    FinishLoadShader(shader, path);
+    return shader;
+}
+
+GLuint LoadProgram(std::vector<GLuint> shaders)
+{
+    GLuint program = BeginLoadProgram(shaders);
+    FinishLoadProgram(program, shaders);
+    return program;
+}
+
+GLuint BeginLoadShader(GLenum type, const std::string& path)
 {
     std::ifstream file (path);
     if (!file.is_open())
@@ -18,6 +32,11 @@ GLuint LoadShader(GLenum type, const std::string& path)
     GLuint shader = glCreateShader(type);
     glShaderSource(shader, 1, &src_data, &file_size);
     glCompileShader(shader);
+    return shader;
+}
+
+void FinishLoadShader(GLuint shader, const std::string& path)
+{
     GLint is_compiled = 0;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &is_compiled);
     if (!is_compiled)
@@ -30,10 +49,9 @@ GLuint LoadShader(GLenum type, const std::string& path)
         DumpLog(log);
         FatalError("Failed to compile shader '" + path + "'.");
     }
-    return shader;
 }
 
-GLuint LoadProgram(std::vector<GLuint> shaders)
+GLuint BeginLoadProgram(const std::vector<GLuint>& shaders)
 {
     GLuint program = glCreateProgram();
     for (GLuint shader : shaders)
@@ -41,6 +59,11 @@ GLuint LoadProgram(std::vector<GLuint> shaders)
         glAttachShader(program, shader);
     }
     glLinkProgram(program);
+    return program;
+}
+
+void FinishLoadProgram(GLuint program, const std::vector<GLuint>& shaders)
+{
     GLint is_linked = 0;
     glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
     if (!is_linked)
@@ -57,5 +80,4 @@ GLuint LoadProgram(std::vector<GLuint> shaders)
     {
         glDetachShader(program, shader);
     }
-    return program;
 }
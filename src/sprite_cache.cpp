@@ -0,0 +1,180 @@
+#include "sprite_cache.hpp"
+#include "error.hpp"
+#include <algorithm>
+
+SpriteCache::SpriteCache(int slots_per_side, int samples)
+    : slots_per_side_ (slots_per_side)
+    , requested_samples_ (samples)
+    , entries_ (slots_per_side * slots_per_side)
+    , lru_pos_ (slots_per_side * slots_per_side)
+{ }
+
+void SpriteCache::resize(int sprite_size)
+{
+    GLint max_texture_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+    sprite_size = std::max(1, std::min(sprite_size, static_cast<int>(max_texture_size) / slots_per_side_));
+    if (texture_ && sprite_size == sprite_size_)
+        return;
+    destroy();
+    sprite_size_ = sprite_size;
+
+    int atlas_size = sprite_size_ * slots_per_side_;
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas_size, atlas_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0u);
+
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        FatalError("Failed to create sprite atlas framebuffer.");
+
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    samples_ = std::min(requested_samples_, static_cast<int>(max_samples));
+    if (samples_ > 0)
+    {
+        // A multisample resolve has to keep the same rectangle, so it goes
+        // through a single-sample buffer before being copied into the slot.
+        glGenRenderbuffers(1, &msaa_color_);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaa_color_);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_RGBA8, sprite_size_, sprite_size_);
+        glGenFramebuffers(1, &msaa_fbo_);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaa_color_);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            FatalError("Failed to create multisampled sprite framebuffer.");
+
+        glGenRenderbuffers(1, &resolve_color_);
+        glBindRenderbuffer(GL_RENDERBUFFER, resolve_color_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, sprite_size_, sprite_size_);
+        glGenFramebuffers(1, &resolve_fbo_);
+        glBindFramebuffer(GL_FRAMEBUFFER, resolve_fbo_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, resolve_color_);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            FatalError("Failed to create sprite resolve framebuffer.");
+        glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0u);
+
+    slot_map_.clear();
+    lru_.clear();
+    for (int slot = 0; slot < static_cast<int>(entries_.size()); slot++)
+    {
+        entries_[slot] = {0ull, 0u};
+        lru_pos_[slot] = lru_.insert(lru_.end(), slot);
+    }
+    // Frame 0 is never current, so every slot starts out evictable.
+    frame_ = 1u;
+}
+
+void SpriteCache::destroy()
+{
+    if (fbo_)
+        glDeleteFramebuffers(1, &fbo_);
+    if (texture_)
+        glDeleteTextures(1, &texture_);
+    if (msaa_fbo_)
+        glDeleteFramebuffers(1, &msaa_fbo_);
+    if (msaa_color_)
+        glDeleteRenderbuffers(1, &msaa_color_);
+    if (resolve_fbo_)
+        glDeleteFramebuffers(1, &resolve_fbo_);
+    if (resolve_color_)
+        glDeleteRenderbuffers(1, &resolve_color_);
+    fbo_ = 0u;
+    texture_ = 0u;
+    msaa_fbo_ = 0u;
+    msaa_color_ = 0u;
+    resolve_fbo_ = 0u;
+    resolve_color_ = 0u;
+}
+
+void SpriteCache::beginFrame()
+{
+    frame_++;
+}
+
+int SpriteCache::acquireSlot(unsigned long long key, bool& r_needs_render)
+{
+    auto found = slot_map_.find(key);
+    if (found != slot_map_.end())
+    {
+        int slot = found->second;
+        entries_[slot].frame = frame_;
+        lru_.splice(lru_.begin(), lru_, lru_pos_[slot]);
+        r_needs_render = false;
+        return slot;
+    }
+    // The back of the list is the least recently used slot. If even that one
+    // is in use this frame the atlas is full and the caller has to draw the
+    // tile some other way.
+    int slot = lru_.back();
+    if (entries_[slot].frame == frame_)
+        return -1;
+    if (entries_[slot].frame != 0u)
+        slot_map_.erase(entries_[slot].key);
+    entries_[slot] = {key, frame_};
+    slot_map_[key] = slot;
+    lru_.splice(lru_.begin(), lru_, lru_pos_[slot]);
+    r_needs_render = true;
+    return slot;
+}
+
+glm::vec4 SpriteCache::getSlotRect(int slot) const
+{
+    float step = 1.f / slots_per_side_;
+    float u = (slot % slots_per_side_) * step;
+    float v = (slot / slots_per_side_) * step;
+    return glm::vec4 {u, v, u + step, v + step};
+}
+
+void SpriteCache::bindSlot(int slot)
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &saved_fbo_);
+    glGetIntegerv(GL_VIEWPORT, saved_viewport_);
+    bound_slot_ = slot;
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    if (samples_ > 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, msaa_fbo_);
+        glViewport(0, 0, sprite_size_, sprite_size_);
+        glClear(GL_COLOR_BUFFER_BIT);
+        return;
+    }
+    int x = (slot % slots_per_side_) * sprite_size_;
+    int y = (slot / slots_per_side_) * sprite_size_;
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glViewport(x, y, sprite_size_, sprite_size_);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x, y, sprite_size_, sprite_size_);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void SpriteCache::unbindSlot()
+{
+    if (samples_ > 0)
+    {
+        int x = (bound_slot_ % slots_per_side_) * sprite_size_;
+        int y = (bound_slot_ / slots_per_side_) * sprite_size_;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, msaa_fbo_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_fbo_);
+        glBlitFramebuffer(0, 0, sprite_size_, sprite_size_, 0, 0, sprite_size_, sprite_size_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, resolve_fbo_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo_);
+        glBlitFramebuffer(0, 0, sprite_size_, sprite_size_, x, y, x + sprite_size_, y + sprite_size_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    else
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    bound_slot_ = -1;
+    glBindFramebuffer(GL_FRAMEBUFFER, saved_fbo_);
+    glViewport(saved_viewport_[0], saved_viewport_[1], saved_viewport_[2], saved_viewport_[3]);
+}
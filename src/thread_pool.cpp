@@ -0,0 +1,84 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+// Chunks handed out per participating thread; more than one evens out load.
+static const int CHUNKS_PER_THREAD = 4;
+
+ThreadPool::ThreadPool(int thread_count)
+    : next_ (0)
+{
+    if (thread_count <= 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < thread_count; i++)
+    {
+        threads_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        is_stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(int count, RangeFunction p_function, const void* p_context)
+{
+    if (count <= 0)
+        return;
+    if (threads_.empty())
+    {
+        p_function(p_context, 0, count);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        p_function_ = p_function;
+        p_context_ = p_context;
+        count_ = count;
+        grain_ = std::max(1, count / (getThreadCount() * CHUNKS_PER_THREAD));
+        next_.store(0);
+        busy_workers_ = static_cast<int>(threads_.size());
+        generation_++;
+    }
+    work_ready_.notify_all();
+    work();
+    std::unique_lock<std::mutex> lock (mutex_);
+    work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        int begin = next_.fetch_add(grain_);
+        if (begin >= count_)
+            return;
+        p_function_(p_context_, begin, std::min(begin + grain_, count_));
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned seen_generation = 0u;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+            work_ready_.wait(lock, [&] { return is_stopping_ || generation_ != seen_generation; });
+            if (is_stopping_)
+                return;
+            seen_generation = generation_;
+        }
+        work();
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (--busy_workers_ == 0)
+            work_done_.notify_one();
+    }
+}
@@ -15,12 +15,22 @@ Direction Tile::getOrientation() const
 
 Position Tile::toLocal(Position src) const
 {
-    return static_cast<Position>((src + 2 * (DIR_LAST - orientation_)) % (2 * DIR_LAST));
+    return toLocal(src, orientation_);
+}
+
+Position Tile::toLocal(Position src, Direction orientation) const
+{
+    return static_cast<Position>((src + 2 * (DIR_LAST - orientation)) % (2 * DIR_LAST));
 }
 
 Position Tile::toGlobal(Position src) const
 {
-    return static_cast<Position>((src + 2 * orientation_) % (2 * DIR_LAST));
+    return toGlobal(src, orientation_);
+}
+
+Position Tile::toGlobal(Position src, Direction orientation) const
+{
+    return static_cast<Position>((src + 2 * orientation) % (2 * DIR_LAST));
 }
 
 Position Tile::getAdjacentPosition(Position from_pos) const
@@ -30,11 +40,16 @@ Position Tile::getAdjacentPosition(Position from_pos) const
 }
 
 Position Tile::getDestination(Position from_pos) const
+{
+    return getDestination(from_pos, orientation_);
+}
+
+Position Tile::getDestination(Position from_pos, Direction orientation) const
 {
     Position src = getAdjacentPosition(from_pos);
-    src = toLocal(src);
+    src = toLocal(src, orientation);
     Position dst = adjacent_[src];
-    return toGlobal(dst);
+    return toGlobal(dst, orientation);
 }
 
 Path* Tile::getPathAtPosition(Position from_pos)
@@ -46,11 +61,43 @@ Path* Tile::getPathAtPosition(Position from_pos)
     return &paths_.at(path_idx);
 }
 
+const Path* Tile::getPathAtPosition(Position from_pos, Direction orientation) const
+{
+    Position src = toLocal(getAdjacentPosition(from_pos), orientation);
+    int path_idx = path_map_[src];
+    if (path_idx < 0)
+        return nullptr;
+    return &paths_.at(path_idx);
+}
+
 std::vector<Path>& Tile::getPaths()
 {
     return paths_;
 }
 
+const std::vector<Path>& Tile::getPaths() const
+{
+    return paths_;
+}
+
+unsigned long long Tile::getAppearanceKey() const
+{
+    // 4 bits of partner per local position, then one taken bit per position.
+    // Orientation is left out since it is just a rotation of the same image.
+    unsigned long long key = 0ull;
+    for (const Path& path : paths_)
+    {
+        key |= static_cast<unsigned long long>(path.end) << (4 * path.begin);
+        key |= static_cast<unsigned long long>(path.begin) << (4 * path.end);
+        if (path.taken)
+        {
+            key |= 1ull << (4 * POS_LAST + path.begin);
+            key |= 1ull << (4 * POS_LAST + path.end);
+        }
+    }
+    return key;
+}
+
 void Tile::setOrientation(Direction orientation) 
 {
     orientation_ = orientation;
@@ -87,6 +134,11 @@ void Tile::randomlyGeneratePaths()
         rand.seed(time(NULL));
         is_seeded = true;
     }
+    randomlyGeneratePaths(rand);
+}
+
+void Tile::randomlyGeneratePaths(std::mt19937& rand)
+{
     clearPaths();
     int avail [POS_LAST];
     for (int i = 0; i < POS_LAST; i++)
@@ -0,0 +1,34 @@
+#include "timeline.hpp"
+#include <iomanip>
+
+static double ToMilliseconds(Timeline::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Timeline::Timeline()
+    : start_ (Clock::now())
+{ }
+
+void Timeline::mark(const std::string& phase)
+{
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock (mutex_);
+    marks_.emplace_back(phase, now);
+}
+
+void Timeline::report(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    Clock::time_point previous = start_;
+    for (const std::pair<std::string, Clock::time_point>& mark : marks_)
+    {
+        out << std::setw(9) << ToMilliseconds(mark.second - start_) << " ms"
+            << "  (+" << ToMilliseconds(mark.second - previous) << " ms)  "
+            << mark.first << std::endl;
+        previous = mark.second;
+    }
+    out.flags(flags);
+}
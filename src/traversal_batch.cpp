@@ -0,0 +1,267 @@
+#include "traversal_batch.hpp"
+#include "error.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRAVERSAL_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+static const int LANES = 8;
+
+static const int STATE_ORIENTATION_SHIFT = POS_LAST;
+static const int32_t STATE_PRESENT = 1 << (POS_LAST + 3);
+
+// Row and column offsets of Board::getTileInDirection, padded to eight lanes.
+static const int32_t DIRECTION_DI [LANES] = {-1, -1, 0, 1, 1, 0, 0, 0};
+static const int32_t DIRECTION_DJ [LANES] = {1, 0, -1, -1, 0, 1, 0, 0};
+
+static int32_t OppositePosition(int32_t pos)
+{
+    return ((pos / 2 + DIR_LAST / 2) % DIR_LAST) * 2 + (pos + 1) % 2;
+}
+
+TraversalBatch::TraversalBatch(int width, int height, int count)
+    : width_ (width)
+    , height_ (height)
+    , cells_ (width * height)
+    , count_ (count)
+    , use_simd_ (HasSimd())
+{
+    // Gather indices are 32-bit, so the packed tables must stay addressable.
+    if (static_cast<long long>(count) * cells_ * 2 >= (1ll << 31))
+        FatalError("Traversal batch is too large.");
+    int padded = (count + LANES - 1) / LANES * LANES;
+    ports_.assign(static_cast<size_t>(padded) * cells_ * 2, 0);
+    state_.assign(static_cast<size_t>(padded) * cells_, 0);
+    i_.assign(padded, 0);
+    j_.assign(padded, 0);
+    pos_.assign(padded, 0);
+    score_.assign(padded, 0);
+    done_.assign(padded, 1);
+}
+
+void TraversalBatch::loadGame(int game, const Board& board, const Tile* p_tile, Position pos)
+{
+    if (board.getWidth() != width_ || board.getHeight() != height_)
+        FatalError("Board does not match traversal batch dimensions.");
+    size_t base = static_cast<size_t>(game) * cells_;
+    for (int i = 0; i < height_; i++)
+    {
+        for (int j = 0; j < width_; j++)
+        {
+            size_t cell = base + i * width_ + j;
+            const Tile* p_cell_tile = board.getTile(i, j);
+            ports_[cell * 2] = 0;
+            ports_[cell * 2 + 1] = 0;
+            state_[cell] = 0;
+            if (!p_cell_tile)
+                continue;
+            const std::vector<Path>& paths = p_cell_tile->getPaths();
+            if (paths.size() * 2 != POS_LAST)
+                FatalError("Traversal batch needs every port of a tile matched.");
+            int32_t state = STATE_PRESENT | (p_cell_tile->getOrientation() << STATE_ORIENTATION_SHIFT);
+            for (const Path& path : paths)
+            {
+                ports_[cell * 2 + path.begin / 8] |= path.end << (4 * (path.begin % 8));
+                ports_[cell * 2 + path.end / 8] |= path.begin << (4 * (path.end % 8));
+                if (path.taken)
+                    state |= (1 << path.begin) | (1 << path.end);
+            }
+            state_[cell] = state;
+        }
+    }
+    bool was_done = done_[game] != 0;
+    pos_[game] = pos;
+    score_[game] = 0;
+    done_[game] = 1;
+    if (p_tile)
+    {
+        i_[game] = p_tile->getI();
+        j_[game] = p_tile->getJ();
+        Position local = p_tile->toLocal(p_tile->getAdjacentPosition(pos));
+        done_[game] = (state_[base + i_[game] * width_ + j_[game]] >> local) & 1;
+    }
+    live_ += static_cast<int>(was_done) - static_cast<int>(done_[game] != 0);
+}
+
+bool TraversalBatch::isLocalPortTaken(int game, int i, int j, Position local) const
+{
+    return (state_[static_cast<size_t>(game) * cells_ + i * width_ + j] >> local) & 1;
+}
+
+void TraversalBatch::step()
+{
+    int padded = static_cast<int>(done_.size());
+    if (use_simd_)
+        stepSimd(0, padded);
+    else
+        stepScalar(0, padded);
+}
+
+int TraversalBatch::run(int max_steps)
+{
+    int steps = 0;
+    while (live_ > 0 && steps < max_steps)
+    {
+        step();
+        steps++;
+    }
+    return steps;
+}
+
+void TraversalBatch::stepScalar(int begin, int end)
+{
+    for (int game = begin; game < end; game++)
+    {
+        if (done_[game])
+            continue;
+        size_t cell = static_cast<size_t>(game) * cells_ + i_[game] * width_ + j_[game];
+        int32_t orientation = (state_[cell] >> STATE_ORIENTATION_SHIFT) & 7;
+        int32_t local = (OppositePosition(pos_[game]) + 2 * (DIR_LAST - orientation)) % POS_LAST;
+        int32_t dst = (ports_[cell * 2 + local / 8] >> (4 * (local % 8))) & 0xF;
+        state_[cell] |= (1 << local) | (1 << dst);
+        int32_t pos = (dst + 2 * orientation) % POS_LAST;
+        int i = i_[game] + DIRECTION_DI[pos / 2];
+        int j = j_[game] + DIRECTION_DJ[pos / 2];
+        pos_[game] = pos;
+        i_[game] = i;
+        j_[game] = j;
+        score_[game]++;
+        bool is_done = true;
+        if (0 <= i && i < height_ && 0 <= j && j < width_)
+        {
+            int32_t state = state_[static_cast<size_t>(game) * cells_ + i * width_ + j];
+            if (state & STATE_PRESENT)
+            {
+                int32_t next_orientation = (state >> STATE_ORIENTATION_SHIFT) & 7;
+                int32_t next_local = (OppositePosition(pos) + 2 * (DIR_LAST - next_orientation)) % POS_LAST;
+                is_done = (state >> next_local) & 1;
+            }
+        }
+        if (is_done)
+        {
+            done_[game] = 1;
+            live_--;
+        }
+    }
+}
+
+#ifdef TRAVERSAL_HAS_AVX2
+
+bool TraversalBatch::HasSimd()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static __m256i Avx2Opposite(__m256i pos)
+{
+    // ((pos / 2 + 3) % 6) * 2 + (pos + 1) % 2
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i dir = _mm256_add_epi32(_mm256_srli_epi32(pos, 1), _mm256_set1_epi32(DIR_LAST / 2));
+    __m256i wrap = _mm256_cmpgt_epi32(dir, _mm256_set1_epi32(DIR_LAST - 1));
+    dir = _mm256_sub_epi32(dir, _mm256_and_si256(wrap, _mm256_set1_epi32(DIR_LAST)));
+    __m256i parity = _mm256_and_si256(_mm256_add_epi32(pos, one), one);
+    return _mm256_add_epi32(_mm256_slli_epi32(dir, 1), parity);
+}
+
+__attribute__((target("avx2")))
+static __m256i Avx2WrapPosition(__m256i pos)
+{
+    // Maps [0, 2 * POS_LAST) onto [0, POS_LAST).
+    __m256i wrap = _mm256_cmpgt_epi32(pos, _mm256_set1_epi32(POS_LAST - 1));
+    return _mm256_sub_epi32(pos, _mm256_and_si256(wrap, _mm256_set1_epi32(POS_LAST)));
+}
+
+__attribute__((target("avx2")))
+void TraversalBatch::stepSimd(int begin, int end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i nibble = _mm256_set1_epi32(0xF);
+    const __m256i seven = _mm256_set1_epi32(7);
+    const __m256i twelve = _mm256_set1_epi32(2 * DIR_LAST);
+    const __m256i width = _mm256_set1_epi32(width_);
+    const __m256i height = _mm256_set1_epi32(height_);
+    const __m256i lane_offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(cells_));
+    const __m256i di_table = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(DIRECTION_DI));
+    const __m256i dj_table = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(DIRECTION_DJ));
+    alignas(32) int32_t cells [LANES];
+    alignas(32) int32_t taken [LANES];
+    for (int game = begin; game < end; game += LANES)
+    {
+        __m256i done = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&done_[game]));
+        __m256i active = _mm256_cmpeq_epi32(done, zero);
+        int active_bits = _mm256_movemask_ps(_mm256_castsi256_ps(active));
+        if (!active_bits)
+            continue;
+        __m256i ci = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&i_[game]));
+        __m256i cj = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&j_[game]));
+        __m256i pos = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&pos_[game]));
+        __m256i score = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&score_[game]));
+        __m256i base = _mm256_add_epi32(_mm256_set1_epi32(game * cells_), lane_offsets);
+
+        // Traverse the current tile.
+        __m256i cell = _mm256_add_epi32(base, _mm256_add_epi32(_mm256_mullo_epi32(ci, width), cj));
+        __m256i state = _mm256_mask_i32gather_epi32(zero, state_.data(), cell, active, 4);
+        __m256i orientation = _mm256_and_si256(_mm256_srli_epi32(state, STATE_ORIENTATION_SHIFT), seven);
+        __m256i rotation = _mm256_slli_epi32(orientation, 1);
+        __m256i local = Avx2WrapPosition(_mm256_sub_epi32(_mm256_add_epi32(Avx2Opposite(pos), twelve), rotation));
+        __m256i port_word = _mm256_add_epi32(_mm256_slli_epi32(cell, 1), _mm256_srli_epi32(local, 3));
+        __m256i ports = _mm256_mask_i32gather_epi32(zero, ports_.data(), port_word, active, 4);
+        __m256i shift = _mm256_slli_epi32(_mm256_and_si256(local, seven), 2);
+        __m256i dst = _mm256_and_si256(_mm256_srlv_epi32(ports, shift), nibble);
+        __m256i taken_bits = _mm256_or_si256(_mm256_sllv_epi32(one, local), _mm256_sllv_epi32(one, dst));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cells), cell);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(taken), taken_bits);
+        // AVX2 has no scatter; games never share cells, so plain stores are safe.
+        for (int lane = 0; lane < LANES; lane++)
+        {
+            if (active_bits & (1 << lane))
+                state_[cells[lane]] |= taken[lane];
+        }
+        __m256i next_pos = Avx2WrapPosition(_mm256_add_epi32(dst, rotation));
+
+        // Step into the neighbouring tile.
+        __m256i dir = _mm256_srli_epi32(next_pos, 1);
+        __m256i ni = _mm256_add_epi32(ci, _mm256_permutevar8x32_epi32(di_table, dir));
+        __m256i nj = _mm256_add_epi32(cj, _mm256_permutevar8x32_epi32(dj_table, dir));
+        __m256i off_grid = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(zero, ni), _mm256_cmpgt_epi32(zero, nj)),
+                _mm256_or_si256(_mm256_cmpgt_epi32(ni, _mm256_sub_epi32(height, one)), _mm256_cmpgt_epi32(nj, _mm256_sub_epi32(width, one))));
+        __m256i on_grid = _mm256_andnot_si256(off_grid, active);
+        __m256i next_cell = _mm256_add_epi32(base, _mm256_add_epi32(_mm256_mullo_epi32(ni, width), nj));
+        __m256i next_state = _mm256_mask_i32gather_epi32(zero, state_.data(), next_cell, on_grid, 4);
+        __m256i present = _mm256_cmpgt_epi32(_mm256_and_si256(next_state, _mm256_set1_epi32(STATE_PRESENT)), zero);
+        __m256i next_rotation = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(next_state, STATE_ORIENTATION_SHIFT), seven), 1);
+        __m256i next_local = Avx2WrapPosition(_mm256_sub_epi32(_mm256_add_epi32(Avx2Opposite(next_pos), twelve), next_rotation));
+        __m256i blocked = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(next_state, next_local), one), one);
+        __m256i stopped = _mm256_and_si256(active, _mm256_or_si256(_mm256_cmpeq_epi32(present, zero), blocked));
+
+        ci = _mm256_blendv_epi8(ci, ni, active);
+        cj = _mm256_blendv_epi8(cj, nj, active);
+        pos = _mm256_blendv_epi8(pos, next_pos, active);
+        score = _mm256_sub_epi32(score, active);
+        done = _mm256_or_si256(done, _mm256_and_si256(stopped, one));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&i_[game]), ci);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&j_[game]), cj);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pos_[game]), pos);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&score_[game]), score);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&done_[game]), done);
+        live_ -= __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(stopped)));
+    }
+}
+
+#else
+
+bool TraversalBatch::HasSimd()
+{
+    return false;
+}
+
+void TraversalBatch::stepSimd(int begin, int end)
+{
+    stepScalar(begin, end);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "analytics.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+
+static const int DEFAULT_MAX_SCORE = 2000;
+static const double PRINT_THRESHOLD = 1e-6;
+
+static void PrintUsage()
+{
+    std::cerr
+        << "usage: tangle-analytics <width> <height> [max_score]"
+        << " [--threads=N] [--playouts=N] [--cache-dir=DIR] [--no-cache]" << std::endl;
+}
+
+int main(int argc, char* argv [])
+{
+    std::vector<int> numbers;
+    int thread_count = 0;
+    int playout_count = 0;
+    std::string cache_dir = ".analytics-cache";
+    bool use_cache = true;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg (argv[i]);
+        if (arg.compare(0, 10, "--threads=") == 0)
+            thread_count = std::atoi(arg.c_str() + 10);
+        else if (arg.compare(0, 11, "--playouts=") == 0)
+            playout_count = std::max(0, std::atoi(arg.c_str() + 11));
+        else if (arg.compare(0, 12, "--cache-dir=") == 0)
+            cache_dir = arg.substr(12);
+        else if (arg == "--no-cache")
+            use_cache = false;
+        else
+            numbers.push_back(std::atoi(arg.c_str()));
+    }
+    if (numbers.size() < 2 || numbers.size() > 3 || numbers[0] <= 0 || numbers[1] <= 0)
+    {
+        PrintUsage();
+        return 1;
+    }
+    int width = numbers[0];
+    int height = numbers[1];
+    int max_score = numbers.size() > 2 ? numbers[2] : DEFAULT_MAX_SCORE;
+
+    ThreadPool pool (thread_count);
+    std::string cache_path = GetScoreAnalysisCachePath(cache_dir, width, height, max_score, playout_count);
+    ScoreAnalysis analysis;
+    if (use_cache && LoadScoreAnalysis(cache_path, analysis))
+    {
+        std::cout << "Loaded cached analysis from " << cache_path << std::endl;
+    }
+    else
+    {
+        TileStatistics stats = ComputeTileStatistics(pool);
+        std::cout << "Tile matchings: " << stats.matching_count << std::endl;
+        std::cout << "Port transitions (row: port left through, column: next port):" << std::endl;
+        std::cout << std::fixed << std::setprecision(4);
+        for (int p = 0; p < POS_LAST; p++)
+        {
+            std::cout << std::setw(4) << p;
+            for (int q = 0; q < POS_LAST; q++)
+            {
+                std::cout << " " << stats.transition[p][q];
+            }
+            std::cout << std::endl;
+        }
+        analysis = AnalyzeScore(stats, width, height, max_score, pool);
+        if (playout_count > 0)
+        {
+            analysis.playout_count = playout_count;
+            analysis.measured_score = MeasureMeanScore(width, height, playout_count, pool);
+        }
+        if (use_cache)
+        {
+            mkdir(cache_dir.c_str(), 0755);
+            if (!SaveScoreAnalysis(cache_path, analysis))
+                std::cerr << "Failed to write cache '" << cache_path << "'." << std::endl;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Board " << width << "x" << height << std::endl;
+    // The chain draws every tile entered afresh, so it misses games that end
+    // early on a revisited tile; playouts measure how much that matters.
+    std::cout << "Approximate expected score (independent-draw chain): " << analysis.chain_score << std::endl;
+    if (analysis.playout_count > 0)
+    {
+        double error = analysis.chain_score - analysis.measured_score;
+        std::cout << "Measured mean score (" << analysis.playout_count << " playouts): "
+                  << analysis.measured_score << std::endl;
+        std::cout << "Chain error: " << std::showpos << error << std::noshowpos
+                  << " (" << 100.0 * error / analysis.measured_score << "%)" << std::endl;
+    }
+    std::cout << "Mass past score " << max_score << ": " << analysis.tail_probability << std::endl;
+    std::cout << "Approximate score distribution (independent-draw chain):" << std::endl;
+    for (size_t n = 0; n < analysis.distribution.size(); n++)
+    {
+        if (analysis.distribution[n] >= PRINT_THRESHOLD)
+            std::cout << std::setw(6) << n << " " << analysis.distribution[n] << std::endl;
+    }
+    return 0;
+}
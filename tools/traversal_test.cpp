@@ -0,0 +1,166 @@
+#include "board.hpp"
+#include "traversal_batch.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks TraversalBatch against Tile::traverse. Every game is a random board
+// played for a random number of moves (with rotations, as a player would)
+// before it is loaded, so the batch starts from taken paths and arbitrary
+// positions. The reference then finishes each game one tile at a time and
+// the scalar and AVX2 batches must agree with it on the score, the final
+// position and every taken path.
+
+static const int BOARD_WIDTH = 9;
+static const int BOARD_HEIGHT = 9;
+static const int DEFAULT_GAME_COUNT = 2003;
+static const int MAX_STEPS = 100000;
+
+struct ReferenceGame
+{
+    std::vector<Tile> tiles;
+    Board board;
+    Tile* p_tile;
+    Position pos;
+
+    ReferenceGame()
+        : tiles (BOARD_WIDTH * BOARD_HEIGHT)
+        , board (BOARD_WIDTH, BOARD_HEIGHT)
+        , p_tile (nullptr)
+        , pos (POS_NORTH_EAST_0)
+    { }
+};
+
+static bool IsFinished(const ReferenceGame& game)
+{
+    return !game.p_tile || game.p_tile->isPathTaken(game.pos);
+}
+
+static void Advance(ReferenceGame& game)
+{
+    game.pos = game.p_tile->traverse(game.pos);
+    game.p_tile = game.board.getTileInAdjacentPosition(game.pos, game.p_tile->getI(), game.p_tile->getJ());
+}
+
+static void SetupGame(ReferenceGame& game, std::mt19937& rand)
+{
+    for (int i = 0; i < BOARD_HEIGHT; i++)
+    {
+        for (int j = 0; j < BOARD_WIDTH; j++)
+        {
+            if (!game.board.isInHexShape(i, j))
+                continue;
+            Tile* p_tile = &game.tiles[i * BOARD_WIDTH + j];
+            p_tile->randomlyGeneratePaths(rand);
+            p_tile->setOrientation(static_cast<Direction>(rand() % DIR_LAST));
+            game.board.setTile(p_tile, i, j);
+        }
+    }
+    game.p_tile = game.board.getTile(BOARD_HEIGHT / 2, BOARD_WIDTH / 2);
+    int moves = rand() % 16;
+    for (int move = 0; move < moves && !IsFinished(game); move++)
+    {
+        if (game.p_tile->canRotate() && rand() % 2)
+        {
+            if (rand() % 2)
+                game.p_tile->rotateLeft();
+            else
+                game.p_tile->rotateRight();
+        }
+        Advance(game);
+    }
+}
+
+static int CountMismatches(const TraversalBatch& batch, int index, const ReferenceGame& game, int score)
+{
+    int mismatches = 0;
+    if (batch.getScore(index) != score)
+        mismatches++;
+    if (batch.getPosition(index) != game.pos)
+        mismatches++;
+    for (int i = 0; i < BOARD_HEIGHT; i++)
+    {
+        for (int j = 0; j < BOARD_WIDTH; j++)
+        {
+            const Tile* p_tile = game.board.getTile(i, j);
+            if (!p_tile)
+                continue;
+            for (const Path& path : p_tile->getPaths())
+            {
+                if (batch.isLocalPortTaken(index, i, j, path.begin) != path.taken)
+                    mismatches++;
+                if (batch.isLocalPortTaken(index, i, j, path.end) != path.taken)
+                    mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char* argv [])
+{
+    int game_count = DEFAULT_GAME_COUNT;
+    unsigned seed = 1u;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg (argv[i]);
+        if (arg.compare(0, 7, "--seed=") == 0)
+            seed = static_cast<unsigned>(std::strtoul(arg.c_str() + 7, nullptr, 10));
+        else
+            game_count = std::atoi(arg.c_str());
+    }
+    if (game_count <= 0)
+    {
+        std::cerr << "usage: traversal-test [game_count] [--seed=N]" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rand (seed);
+    std::vector<ReferenceGame> games (game_count);
+    TraversalBatch scalar (BOARD_WIDTH, BOARD_HEIGHT, game_count);
+    TraversalBatch simd (BOARD_WIDTH, BOARD_HEIGHT, game_count);
+    scalar.setUseSimd(false);
+    simd.setUseSimd(true);
+    for (int index = 0; index < game_count; index++)
+    {
+        ReferenceGame& game = games[index];
+        SetupGame(game, rand);
+        scalar.loadGame(index, game.board, game.p_tile, game.pos);
+        simd.loadGame(index, game.board, game.p_tile, game.pos);
+    }
+    scalar.run(MAX_STEPS);
+    simd.run(MAX_STEPS);
+
+    int scalar_mismatches = 0;
+    int simd_mismatches = 0;
+    long long total_score = 0;
+    for (int index = 0; index < game_count; index++)
+    {
+        ReferenceGame& game = games[index];
+        int score = 0;
+        while (!IsFinished(game))
+        {
+            Advance(game);
+            score++;
+        }
+        total_score += score;
+        scalar_mismatches += CountMismatches(scalar, index, game, score);
+        simd_mismatches += CountMismatches(simd, index, game, score);
+    }
+
+    std::cout << "Games: " << game_count << " (seed " << seed << "), mean remaining score "
+              << static_cast<double>(total_score) / game_count << std::endl;
+    std::cout << "Scalar mismatches: " << scalar_mismatches << std::endl;
+    if (TraversalBatch::HasSimd())
+        std::cout << "AVX2 mismatches: " << simd_mismatches << std::endl;
+    else
+        std::cout << "AVX2 unavailable; second batch ran the scalar loop" << std::endl;
+    if (scalar.getLiveCount() != 0 || simd.getLiveCount() != 0)
+    {
+        std::cout << "Games still live after " << MAX_STEPS << " steps" << std::endl;
+        return 1;
+    }
+    return scalar_mismatches + simd_mismatches == 0 ? 0 : 1;
+}